@@ -3,24 +3,65 @@
 namespace http_handler {
 
 ApiHandler::ApiHandler(app::Application& app)
-    : app_{app} {
+    : app_{app}
+    , map_cache_{app.ListMaps()} {
+    app_.SetTickListener([this](model::GameSession& session) {
+        state_subscribers_.Publish(session, [this, &session](StateFormat format) {
+            return state_cache_.GetState(session, format);
+        });
+    });
 }
 
-StringResponse ApiHandler::MakeStringResponse(http::status status, std::string_view body, unsigned version, bool keep_alive, http::verb method, std::string_view content_type, std::optional<std::pair<http::field, std::string_view>> extra_header) {
+StringResponse ApiHandler::MakeStringResponse(http::status status, std::string body, unsigned version, bool keep_alive, http::verb method, std::string_view content_type, std::optional<std::pair<http::field, std::string_view>> extra_header) {
     StringResponse res{status, version};
-    res.set(http::field::content_type, std::string(content_type));
+    res.set(http::field::content_type, ToHeaderValue(content_type));
     res.set(http::field::cache_control, "no-cache");
     if(extra_header) {
-        res.set(extra_header->first, std::string(extra_header->second));
+        res.set(extra_header->first, ToHeaderValue(extra_header->second));
     }
     res.content_length(body.size());
     res.keep_alive(keep_alive);
 
     if (method != http::verb::head) {
-        res.body() = std::string(body);
+        res.body() = std::move(body);
     }
     
     return res;
 }
 
+SharedStringResponse ApiHandler::MakeSharedResponse(std::shared_ptr<const std::string> body, unsigned version, bool keep_alive, http::verb method, std::string_view content_type) {
+    SharedStringResponse res{http::status::ok, version};
+    res.set(http::field::content_type, ToHeaderValue(content_type));
+    res.set(http::field::cache_control, "no-cache");
+    res.content_length(body->size());
+    res.keep_alive(keep_alive);
+
+    if (method != http::verb::head) {
+        res.body() = std::move(body);
+    }
+
+    return res;
+}
+
+SharedStringResponse ApiHandler::MakeCachedResponse(const MapCache::Entry& entry, unsigned version, bool keep_alive, http::verb method) {
+    auto res = MakeSharedResponse(entry.body, version, keep_alive, method);
+    res.set(http::field::etag, entry.etag);
+    return res;
+}
+
+EmptyResponse ApiHandler::MakeNotModifiedResponse(std::string_view etag, unsigned version, bool keep_alive) {
+    EmptyResponse res{http::status::not_modified, version};
+    res.set(http::field::cache_control, "no-cache");
+    res.set(http::field::etag, ToHeaderValue(etag));
+    res.keep_alive(keep_alive);
+    return res;
+}
+
+StringResponse ApiHandler::MakeErrorResponse(http::status status, std::string_view code, std::string_view message, unsigned version, bool keep_alive, http::verb method, std::optional<std::pair<http::field, std::string_view>> extra_header) {
+    json::object obj;
+    obj["code"] = std::string(code);
+    obj["message"] = std::string(message);
+    return MakeStringResponse(status, json::serialize(obj), version, keep_alive, method, "application/json"sv, extra_header);
+}
+
 }  // namespace http_handler
\ No newline at end of file
@@ -3,13 +3,21 @@
 #include "model.h"
 #include "application.h"
 #include "json_serializer.h"
+#include "binary_serializer.h"
+#include "api_router.h"
+#include "content_negotiation.h"
+#include "http_cache.h"
+#include "map_cache.h"
+#include "state_cache.h"
+#include "state_subscribers.h"
 #include <boost/json.hpp>
 #include <string>
 #include <filesystem>
 #include <optional>
-#include <regex>
 #include <boost/asio/dispatch.hpp>
+#include <boost/beast/websocket.hpp>
 #include <chrono>
+#include <charconv>
 
 namespace http_handler {
 
@@ -18,9 +26,12 @@ namespace http = beast::http;
 namespace json = boost::json;
 namespace fs = std::filesystem;
 namespace net = boost::asio;
+namespace websocket = beast::websocket;
 using namespace std::literals;
 
-using StringResponse = http::response<http::string_body>;
+// Заголовки ответов размещаются в пуле, поэтому сборка ответа не обращается к куче
+using StringResponse = http::response<http::string_body, http_server::ResponseFields>;
+using EmptyResponse = http::response<http::empty_body, http_server::ResponseFields>;
 
 class ApiHandler {
 public:
@@ -29,62 +40,66 @@ public:
     ApiHandler(const ApiHandler&) = delete;
     ApiHandler& operator=(const ApiHandler&) = delete;
 
+    // Запрос обрабатывается в потоке, из которого он пришёл. Работа с игровой сессией
+    // переносится в strand этой сессии, поэтому запросы к разным картам не блокируют друг друга
     template <typename Body, typename Allocator, typename Send>
     void operator()(http::request<Body, http::basic_fields<Allocator>>&& req, Send&& send) {
-        net::dispatch(app_.GetStrand(),
-            [this, req = std::move(req), send = std::forward<Send>(send)]() mutable {
-                HandleApiRequest(std::move(req), std::forward<Send>(send));
-            }
-        );
+        HandleApiRequest(std::move(req), std::forward<Send>(send));
     }
 
 private:
-    StringResponse MakeStringResponse(http::status status, std::string_view body, unsigned version, bool keep_alive, http::verb method, std::string_view content_type = "application/json"sv, std::optional<std::pair<http::field, std::string_view>> extra_header = std::nullopt);
+    StringResponse MakeStringResponse(http::status status, std::string body, unsigned version, bool keep_alive, http::verb method, std::string_view content_type = "application/json"sv, std::optional<std::pair<http::field, std::string_view>> extra_header = std::nullopt);
+    SharedStringResponse MakeSharedResponse(std::shared_ptr<const std::string> body, unsigned version, bool keep_alive, http::verb method, std::string_view content_type = "application/json"sv);
+    SharedStringResponse MakeCachedResponse(const MapCache::Entry& entry, unsigned version, bool keep_alive, http::verb method);
+    EmptyResponse MakeNotModifiedResponse(std::string_view etag, unsigned version, bool keep_alive);
+    StringResponse MakeErrorResponse(http::status status, std::string_view code, std::string_view message, unsigned version, bool keep_alive, http::verb method, std::optional<std::pair<http::field, std::string_view>> extra_header = std::nullopt);
     
     template <typename Body, typename Allocator>
-    std::optional<Token> TryExtractToken(const http::request<Body, http::basic_fields<Allocator>>& req);
+    static StateFormat GetStateFormat(const http::request<Body, http::basic_fields<Allocator>>& req);
+
+    template <typename Body, typename Allocator>
+    std::optional<app::Token> TryExtractToken(const http::request<Body, http::basic_fields<Allocator>>& req);
     
     template <typename Body, typename Allocator, typename Send>
     void HandleApiRequest(http::request<Body, http::basic_fields<Allocator>>&& req, Send&& send);
 
     app::Application& app_;
+    MapCache map_cache_;
+    StateCache state_cache_;
+    StateSubscribers state_subscribers_;
 };
 
 template <typename Body, typename Allocator, typename Send>
 void ApiHandler::HandleApiRequest(http::request<Body, http::basic_fields<Allocator>>&& req, Send&& send) {
     const auto version = req.version();
     const auto keep_alive = req.keep_alive();
-    const std::string target(req.target());
+    const auto target = req.target();
     const auto method = req.method();
 
     auto bad_request = [&](std::string_view message, std::string_view code = "badRequest") {
-        json::object obj;
-        obj["code"] = std::string(code);
-        obj["message"] = std::string(message);
-        send(this->MakeStringResponse(http::status::bad_request, json::serialize(obj), version, keep_alive, method));
+        send(this->MakeErrorResponse(http::status::bad_request, code, message, version, keep_alive, method));
     };
     auto not_found = [&](std::string_view message) {
-        json::object obj;
-        obj["code"] = "mapNotFound";
-        obj["message"] = std::string(message);
-        send(this->MakeStringResponse(http::status::not_found, json::serialize(obj), version, keep_alive, method));
+        send(this->MakeErrorResponse(http::status::not_found, "mapNotFound", message, version, keep_alive, method));
     };
-    auto invalid_method = [&](std::string_view allow, std::string_view message = "Invalid method") {
-        json::object obj;
-        obj["code"] = "invalidMethod";
-        obj["message"] = std::string(message);
-        send(this->MakeStringResponse(http::status::method_not_allowed, json::serialize(obj), version, keep_alive, method, "application/json", {{http::field::allow, allow}} ));
+    auto invalid_method = [&](std::string_view allow, std::string_view message) {
+        send(this->MakeErrorResponse(http::status::method_not_allowed, "invalidMethod", message, version, keep_alive, method, {{http::field::allow, allow}}));
     };
     auto unauthorized = [&](std::string_view code, std::string_view message) {
-        json::object obj;
-        obj["code"] = std::string(code);
-        obj["message"] = std::string(message);
-        send(this->MakeStringResponse(http::status::unauthorized, json::serialize(obj), version, keep_alive, method));
+        send(this->MakeErrorResponse(http::status::unauthorized, code, message, version, keep_alive, method));
+    };
+    auto send_cached = [&](const MapCache::Entry& entry) {
+        if (auto it = req.find(http::field::if_none_match);
+            it != req.end() && IfNoneMatchHits({it->value().data(), it->value().size()}, entry.etag)) {
+            return send(this->MakeNotModifiedResponse(entry.etag, version, keep_alive));
+        }
+        send(this->MakeCachedResponse(entry, version, keep_alive, method));
     };
 
-    auto handle_authorized = 
-        [&](auto&& request, auto&& sender, auto&& action) {
-        auto token_opt = TryExtractToken(request);
+    // action выполняется в strand сессии игрока уже после выхода из HandleApiRequest,
+    // поэтому всё нужное ему он должен захватывать по значению
+    auto handle_authorized = [&](auto&& action) {
+        auto token_opt = TryExtractToken(req);
         if(!token_opt) {
             return unauthorized("invalidToken", "Authorization header is required");
         }
@@ -93,169 +108,218 @@ void ApiHandler::HandleApiRequest(http::request<Body, http::basic_fields<Allocat
         if (!player) {
             return unauthorized("unknownToken", "Player token has not been found");
         }
-        action(player, std::forward<decltype(request)>(request), std::forward<decltype(sender)>(sender));
+        net::dispatch(app_.GetSessionStrand(*player->GetSession()),
+            [player, request = std::move(req), sender = std::forward<Send>(send), action = std::forward<decltype(action)>(action)]() mutable {
+                action(player, request, sender);
+            });
     };
 
-    if (target == "/api/v1/maps"sv) {
-        if (req.method() != http::verb::get && req.method() != http::verb::head) return invalid_method("GET, HEAD");
-        
-        json::array maps_array;
-        for (const auto& map : app_.ListMaps()) {
-            maps_array.push_back(json_serializer::ToJson(map, true));
-        }
-        return send(this->MakeStringResponse(http::status::ok, json::serialize(maps_array), version, keep_alive, method));
+    const auto route_match = MatchRoute({target.data(), target.size()});
+    if (!route_match) {
+        return bad_request("Bad request");
     }
-
-    if (target.starts_with("/api/v1/maps/"sv)) {
-        if (req.method() != http::verb::get && req.method() != http::verb::head) return invalid_method("GET, HEAD");
-        
-        std::string_view map_id_str = target;
-        map_id_str.remove_prefix(("/api/v1/maps/"sv).length());
-        
-        const model::Map* map = app_.FindMap(model::Map::Id{std::string{map_id_str}});
-        if (!map) return not_found("Map not found");
-
-        return send(this->MakeStringResponse(http::status::ok, json::serialize(json_serializer::ToJson(*map, false)), version, keep_alive, method));
+    const Route& route = *route_match->route;
+    // Пока работает встроенный таймер, ручного управления временем нет
+    if (route.endpoint == Endpoint::TICK && !app_.IsManualTickAllowed()) {
+        return bad_request("Invalid endpoint");
+    }
+    if (!route.methods.Contains(method)) {
+        return invalid_method(route.methods.GetAllowHeader(), route.invalid_method_message);
     }
 
-    if (target == "/api/v1/game/join") {
-        if (req.method() != http::verb::post) return invalid_method("POST", "Only POST method is expected");
-        
-        json::value jv;
-        try {
-            jv = json::parse(req.body());
-        } catch (...) {
-            return bad_request("Join game request parse error", "invalidArgument");
-        }
-        
-        if(!jv.is_object() || !jv.as_object().contains("userName") || !jv.as_object().contains("mapId")) {
-            return bad_request("Join game request parse error", "invalidArgument");
+    switch (route.endpoint) {
+        case Endpoint::MAPS: {
+            return send_cached(map_cache_.GetMapList());
         }
 
-        const auto& obj = jv.as_object();
-        std::string user_name;
-        std::string map_id_str;
-        try {
-            user_name = obj.at("userName").as_string().c_str();
-            map_id_str = obj.at("mapId").as_string().c_str();
-        } catch (...) {
-            return bad_request("Join game request parse error", "invalidArgument");
-        }
+        case Endpoint::MAP: {
+            const MapCache::Entry* entry = map_cache_.FindMap(route_match->param);
+            if (!entry) return not_found("Map not found");
 
-        if (user_name.empty()) {
-             return bad_request("Invalid name", "invalidArgument");
+            return send_cached(*entry);
         }
+
+        case Endpoint::JOIN: {
+            json::value jv;
+            try {
+                jv = json::parse(req.body());
+            } catch (...) {
+                return bad_request("Join game request parse error", "invalidArgument");
+            }
         
-        auto join_result = app_.JoinGame(model::Map::Id{map_id_str}, user_name);
-        if(!join_result) {
-            return not_found("Map not found");
-        }
+            if(!jv.is_object() || !jv.as_object().contains("userName") || !jv.as_object().contains("mapId")) {
+                return bad_request("Join game request parse error", "invalidArgument");
+            }
 
-        json::object resp_obj;
-        resp_obj["authToken"] = *join_result->token;
-        resp_obj["playerId"] = *join_result->player_id;
-        return send(this->MakeStringResponse(http::status::ok, json::serialize(resp_obj), version, keep_alive, method));
-    }
+            const auto& obj = jv.as_object();
+            std::string user_name;
+            std::string map_id_str;
+            try {
+                user_name = obj.at("userName").as_string().c_str();
+                map_id_str = obj.at("mapId").as_string().c_str();
+            } catch (...) {
+                return bad_request("Join game request parse error", "invalidArgument");
+            }
 
-    if (target == "/api/v1/game/players") {
-        if (req.method() != http::verb::get && req.method() != http::verb::head) return invalid_method("GET, HEAD");
+            if (user_name.empty()) {
+                 return bad_request("Invalid name", "invalidArgument");
+            }
         
-        return handle_authorized(std::move(req), std::forward<Send>(send), 
-            [&](app::Player* player, auto&&, auto&& sender){
-                json::object players_obj;
-                for (const auto& dog_ptr : player->GetSession()->GetDogs()) {
-                    json::object player_info;
-                    player_info["name"] = dog_ptr->GetName();
-                    players_obj[std::to_string(*dog_ptr->GetId())] = player_info;
-                }
-                sender(this->MakeStringResponse(http::status::ok, json::serialize(players_obj), version, keep_alive, method));
-            });
-    }
+            model::GameSession* session = app_.GetSession(model::Map::Id{map_id_str});
+            if (!session) {
+                return not_found("Map not found");
+            }
 
-    if (target == "/api/v1/game/state") {
-        if (req.method() != http::verb::get && req.method() != http::verb::head) return invalid_method("GET, HEAD", "Invalid method");
+            net::dispatch(app_.GetSessionStrand(*session),
+                [this, session, user_name = std::move(user_name), send = std::forward<Send>(send), version, keep_alive, method]() mutable {
+                    auto join_result = app_.JoinGame(*session, user_name);
 
-        return handle_authorized(std::move(req), std::forward<Send>(send), 
-            [&](app::Player* player, auto&&, auto&& sender){
-                json::object players_obj;
-                for (const auto& dog_ptr : player->GetSession()->GetDogs()) {
-                    players_obj[std::to_string(*dog_ptr->GetId())] = json_serializer::ToJson(*dog_ptr);
-                }
-                json::object root_obj;
-                root_obj["players"] = players_obj;
-                sender(this->MakeStringResponse(http::status::ok, json::serialize(root_obj), version, keep_alive, method));
-            });
-    }
+                    json::object resp_obj;
+                    resp_obj["authToken"] = join_result.token.ToHex();
+                    resp_obj["playerId"] = *join_result.player_id;
+                    send(this->MakeStringResponse(http::status::ok, json::serialize(resp_obj), version, keep_alive, method));
+                });
+            return;
+        }
 
-    if (target == "/api/v1/game/player/action") {
-        if (req.method() != http::verb::post) return invalid_method("POST", "Invalid method");
-        
-        if (req.find(http::field::content_type) == req.end() || req.at(http::field::content_type) != "application/json") {
-            return bad_request("Invalid content type", "invalidArgument");
+        case Endpoint::PLAYERS: {
+            return handle_authorized(
+                [this, version, keep_alive, method](app::Player* player, auto&, auto& sender) {
+                    json::object players_obj;
+                    for (const auto& dog_ptr : player->GetSession()->GetDogs()) {
+                        json::object player_info;
+                        player_info["name"] = dog_ptr->GetName();
+                        players_obj[std::to_string(*dog_ptr->GetId())] = player_info;
+                    }
+                    sender(this->MakeStringResponse(http::status::ok, json::serialize(players_obj), version, keep_alive, method));
+                });
         }
 
-        return handle_authorized(std::move(req), std::forward<Send>(send), 
-            [&](app::Player* player, auto&& request, auto&& sender){
-                json::value jv;
-                try {
-                    jv = json::parse(request.body());
-                } catch (...) {
-                    return bad_request("Failed to parse action", "invalidArgument");
-                }
-                if (!jv.is_object() || !jv.as_object().contains("move")) {
-                    return bad_request("Failed to parse action", "invalidArgument");
-                }
-                std::string move_cmd;
-                try {
-                    move_cmd = jv.as_object().at("move").as_string().c_str();
-                } catch(...) {
-                    return bad_request("Failed to parse action", "invalidArgument");
+        case Endpoint::STATE: {
+            if (auto since_str = FindQueryParam(route_match->query, "since"sv)) {
+                uint64_t since = 0;
+                const auto [ptr, ec] = std::from_chars(since_str->data(), since_str->data() + since_str->size(), since);
+                if (ec != std::errc{} || ptr != since_str->data() + since_str->size()) {
+                    return bad_request("Invalid state version", "invalidArgument");
                 }
+                return handle_authorized(
+                    [this, since, version, keep_alive, method](app::Player* player, auto&, auto& sender) {
+                        const model::GameSession& session = *player->GetSession();
+                        std::string body;
+                        // Если журнал сессии уже не покрывает since, клиент получает полное состояние
+                        if (auto changed = session.GetDogsChangedSince(since)) {
+                            json_serializer::AppendGameStateDelta(body, session.GetVersion(), false, *changed);
+                        } else {
+                            json_serializer::AppendGameStateDelta(body, session.GetVersion(), true, session.GetDogs());
+                        }
+                        sender(this->MakeStringResponse(http::status::ok, std::move(body), version, keep_alive, method));
+                    });
+            }
+            const StateFormat format = GetStateFormat(req);
+            return handle_authorized(
+                [this, format, version, keep_alive, method](app::Player* player, auto&, auto& sender) {
+                    const auto content_type = format == StateFormat::BINARY ? binary_serializer::DOG_STATE_CONTENT_TYPE : "application/json"sv;
+                    // Все читатели между двумя изменениями сессии получают один и тот же буфер
+                    auto res = this->MakeSharedResponse(state_cache_.GetState(*player->GetSession(), format), version, keep_alive, method, content_type);
+                    res.set(http::field::vary, "Accept");
+                    sender(std::move(res));
+                });
+        }
 
-                if (move_cmd != "L" && move_cmd != "R" && move_cmd != "U" && move_cmd != "D" && move_cmd != "") {
-                    return bad_request("Failed to parse action", "invalidArgument");
-                }
+        case Endpoint::STATE_STREAM: {
+            if (!websocket::is_upgrade(req)) {
+                return bad_request("WebSocket upgrade is expected");
+            }
+            // Двоичное состояние передаётся двоичными кадрами
+            const StateFormat format = GetStateFormat(req);
+            return handle_authorized(
+                [this, format](app::Player* player, auto& request, auto& sender) {
+                    const model::GameSession& session = *player->GetSession();
+                    sender(http_server::WebSocketAccept{std::move(request),
+                        [this, &session, format](std::shared_ptr<http_server::WebSocketSession> subscriber) {
+                            // Текущее состояние отправляется сразу, следующие - после каждого тика
+                            subscriber->Send(state_cache_.GetState(session, format), format == StateFormat::BINARY);
+                            state_subscribers_.Add(session, subscriber, format);
+                        }});
+                });
+        }
 
-                app_.MovePlayer(player, move_cmd);
-                sender(this->MakeStringResponse(http::status::ok, "{}", version, keep_alive, method));
-            });
-    }
+        case Endpoint::PLAYER_ACTION: {
+            if (req.find(http::field::content_type) == req.end() || req.at(http::field::content_type) != "application/json") {
+                return bad_request("Invalid content type", "invalidArgument");
+            }
 
-    if (target == "/api/v1/game/tick") {
-        if (req.method() != http::verb::post) {
-            return invalid_method("POST", "Invalid method");
-        }
-        if (req.find(http::field::content_type) == req.end() || req.at(http::field::content_type) != "application/json") {
-            return bad_request("Invalid content type", "invalidArgument");
+            return handle_authorized(
+                [this, version, keep_alive, method](app::Player* player, auto& request, auto& sender) {
+                    auto parse_error = [&] {
+                        sender(this->MakeErrorResponse(http::status::bad_request, "invalidArgument", "Failed to parse action", version, keep_alive, method));
+                    };
+                    json::value jv;
+                    try {
+                        jv = json::parse(request.body());
+                    } catch (...) {
+                        return parse_error();
+                    }
+                    if (!jv.is_object() || !jv.as_object().contains("move")) {
+                        return parse_error();
+                    }
+                    std::string move_cmd;
+                    try {
+                        move_cmd = jv.as_object().at("move").as_string().c_str();
+                    } catch(...) {
+                        return parse_error();
+                    }
+
+                    if (move_cmd != "L" && move_cmd != "R" && move_cmd != "U" && move_cmd != "D" && move_cmd != "") {
+                        return parse_error();
+                    }
+
+                    app_.MovePlayer(player, move_cmd);
+                    sender(this->MakeStringResponse(http::status::ok, "{}", version, keep_alive, method));
+                });
         }
-        try {
-            json::value jv = json::parse(req.body());
-            auto delta_ms = jv.as_object().at("timeDelta").as_int64();
-            app_.Tick(std::chrono::milliseconds(delta_ms));
-        } catch (...) {
-            return bad_request("Failed to parse tick request JSON", "invalidArgument");
+
+        case Endpoint::TICK: {
+            if (req.find(http::field::content_type) == req.end() || req.at(http::field::content_type) != "application/json") {
+                return bad_request("Invalid content type", "invalidArgument");
+            }
+            std::chrono::milliseconds delta{};
+            try {
+                json::value jv = json::parse(req.body());
+                delta = std::chrono::milliseconds(jv.as_object().at("timeDelta").as_int64());
+            } catch (...) {
+                return bad_request("Failed to parse tick request JSON", "invalidArgument");
+            }
+            // Ответ уходит, когда тик выполнен во всех сессиях
+            return app_.Tick(delta, [this, send = std::forward<Send>(send), version, keep_alive, method]() mutable {
+                send(this->MakeStringResponse(http::status::ok, "{}", version, keep_alive, method));
+            });
         }
-        return send(this->MakeStringResponse(http::status::ok, "{}", version, keep_alive, method));
     }
-    
-    return bad_request("Bad request");
 }
 
 template <typename Body, typename Allocator>
-std::optional<Token> ApiHandler::TryExtractToken(const http::request<Body, http::basic_fields<Allocator>>& req) {
-    if (req.count(http::field::authorization) == 0) {
-        return std::nullopt;
+StateFormat ApiHandler::GetStateFormat(const http::request<Body, http::basic_fields<Allocator>>& req) {
+    auto it = req.find(http::field::accept);
+    if (it == req.end()) {
+        return StateFormat::JSON;
     }
-    
-    std::string auth_header{req.at(http::field::authorization)};
-    std::regex bearer_regex(R"(^Bearer\s+([0-9a-fA-F]{32})$)", std::regex::icase);
-    std::smatch match;
 
-    if (std::regex_match(auth_header, match, bearer_regex)) {
-        return Token{match[1].str()};
+    const auto value = it->value();
+    return AcceptsMediaType({value.data(), value.size()}, binary_serializer::DOG_STATE_CONTENT_TYPE)
+        ? StateFormat::BINARY
+        : StateFormat::JSON;
+}
+
+template <typename Body, typename Allocator>
+std::optional<app::Token> ApiHandler::TryExtractToken(const http::request<Body, http::basic_fields<Allocator>>& req) {
+    auto it = req.find(http::field::authorization);
+    if (it == req.end()) {
+        return std::nullopt;
     }
 
-    return std::nullopt;
+    const auto value = it->value();
+    return app::ParseBearerToken({value.data(), value.size()});
 }
 
 } // namespace http_handler
\ No newline at end of file
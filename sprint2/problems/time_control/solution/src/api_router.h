@@ -0,0 +1,240 @@
+#pragma once
+#include <boost/beast/http.hpp>
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+#include <string_view>
+
+namespace http_handler {
+
+namespace http = boost::beast::http;
+using namespace std::literals;
+
+enum class Endpoint {
+    MAPS,
+    MAP,
+    JOIN,
+    PLAYERS,
+    STATE,
+    STATE_STREAM,
+    PLAYER_ACTION,
+    TICK,
+};
+
+// Множество HTTP-методов. Текст заголовка Allow строится из него же на этапе компиляции
+class MethodSet {
+public:
+    constexpr MethodSet(std::initializer_list<http::verb> verbs) {
+        for (http::verb verb : verbs) {
+            mask_ |= Bit(verb);
+            for (char c : VerbName(verb)) {
+                allow_[allow_size_++] = c;
+            }
+            allow_[allow_size_++] = ',';
+            allow_[allow_size_++] = ' ';
+        }
+        allow_size_ -= 2;
+    }
+
+    constexpr bool Contains(http::verb verb) const {
+        return (mask_ & Bit(verb)) != 0;
+    }
+
+    constexpr std::string_view GetAllowHeader() const {
+        return {allow_.data(), allow_size_};
+    }
+
+private:
+    static constexpr uint64_t Bit(http::verb verb) {
+        return uint64_t{1} << static_cast<unsigned>(verb);
+    }
+
+    // boost::beast::http::to_string не constexpr, поэтому имена методов API перечислены здесь
+    static constexpr std::string_view VerbName(http::verb verb) {
+        switch (verb) {
+            case http::verb::get:
+                return "GET"sv;
+            case http::verb::head:
+                return "HEAD"sv;
+            case http::verb::post:
+                return "POST"sv;
+            case http::verb::put:
+                return "PUT"sv;
+            case http::verb::delete_:
+                return "DELETE"sv;
+            case http::verb::patch:
+                return "PATCH"sv;
+            default:
+                throw "Unsupported method in route table";
+        }
+    }
+
+    uint64_t mask_ = 0;
+    std::array<char, 48> allow_{};
+    size_t allow_size_ = 0;
+};
+
+struct Route {
+    // Для маршрутов с параметром - префикс вида "/api/v1/<ресурс>/", параметр - остаток цели
+    std::string_view path;
+    bool has_param;
+    Endpoint endpoint;
+    MethodSet methods;
+    std::string_view invalid_method_message = "Invalid method"sv;
+    // Остальные маршруты не допускают строку запроса после '?'
+    bool accepts_query = false;
+};
+
+struct RouteMatch {
+    const Route* route;
+    std::string_view param;
+    std::string_view query;
+};
+
+constexpr std::string_view API_PREFIX = "/api/v1/"sv;
+
+namespace detail {
+
+constexpr std::array ROUTES = {
+    Route{"/api/v1/maps"sv, false, Endpoint::MAPS, {http::verb::get, http::verb::head}},
+    Route{"/api/v1/maps/"sv, true, Endpoint::MAP, {http::verb::get, http::verb::head}},
+    Route{"/api/v1/game/join"sv, false, Endpoint::JOIN, {http::verb::post}, "Only POST method is expected"sv},
+    Route{"/api/v1/game/players"sv, false, Endpoint::PLAYERS, {http::verb::get, http::verb::head}},
+    Route{"/api/v1/game/state"sv, false, Endpoint::STATE, {http::verb::get, http::verb::head}, "Invalid method"sv, true},
+    Route{"/api/v1/game/state/stream"sv, false, Endpoint::STATE_STREAM, {http::verb::get}},
+    Route{"/api/v1/game/player/action"sv, false, Endpoint::PLAYER_ACTION, {http::verb::post}},
+    Route{"/api/v1/game/tick"sv, false, Endpoint::TICK, {http::verb::post}},
+};
+
+constexpr size_t ROUTE_TABLE_SIZE = 16;
+constexpr uint8_t EMPTY_SLOT = 0xFF;
+static_assert(ROUTES.size() < ROUTE_TABLE_SIZE);
+
+constexpr size_t RouteSlot(std::string_view path, uint64_t seed) {
+    // FNV-1a с подобранным начальным значением
+    uint64_t hash = 0xCBF29CE484222325ull ^ seed;
+    for (char c : path) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001B3ull;
+    }
+    return static_cast<size_t>(hash >> 32) % ROUTE_TABLE_SIZE;
+}
+
+constexpr bool IsPerfectSeed(uint64_t seed) {
+    std::array<bool, ROUTE_TABLE_SIZE> used{};
+    for (const Route& route : ROUTES) {
+        const size_t slot = RouteSlot(route.path, seed);
+        if (used[slot]) {
+            return false;
+        }
+        used[slot] = true;
+    }
+    return true;
+}
+
+constexpr uint64_t FindPerfectSeed() {
+    for (uint64_t seed = 0;; ++seed) {
+        if (IsPerfectSeed(seed)) {
+            return seed;
+        }
+    }
+}
+
+constexpr bool IsWellFormed(const Route& route) {
+    if (!route.path.starts_with(API_PREFIX)) {
+        return false;
+    }
+    if (!route.has_param) {
+        return true;
+    }
+    // MatchRoute отделяет параметр по первому '/' после префикса API
+    return route.path.find('/', API_PREFIX.size()) == route.path.size() - 1;
+}
+
+constexpr bool AllRoutesWellFormed() {
+    for (const Route& route : ROUTES) {
+        if (!IsWellFormed(route)) {
+            return false;
+        }
+    }
+    return true;
+}
+static_assert(AllRoutesWellFormed(), "Parametrized routes must look like /api/v1/<resource>/");
+
+constexpr uint64_t ROUTE_SEED = FindPerfectSeed();
+
+constexpr std::array<uint8_t, ROUTE_TABLE_SIZE> BuildRouteTable() {
+    std::array<uint8_t, ROUTE_TABLE_SIZE> table{};
+    for (auto& slot : table) {
+        slot = EMPTY_SLOT;
+    }
+    for (size_t i = 0; i < ROUTES.size(); ++i) {
+        table[RouteSlot(ROUTES[i].path, ROUTE_SEED)] = static_cast<uint8_t>(i);
+    }
+    return table;
+}
+
+constexpr std::array<uint8_t, ROUTE_TABLE_SIZE> ROUTE_TABLE = BuildRouteTable();
+
+constexpr const Route* FindRoute(std::string_view path) {
+    const uint8_t index = ROUTE_TABLE[RouteSlot(path, ROUTE_SEED)];
+    if (index == EMPTY_SLOT || ROUTES[index].path != path) {
+        return nullptr;
+    }
+    return &ROUTES[index];
+}
+
+}  // namespace detail
+
+namespace detail {
+
+constexpr std::optional<RouteMatch> MatchPath(std::string_view path) {
+    if (const Route* route = FindRoute(path); route && !route->has_param) {
+        return RouteMatch{route, {}, {}};
+    }
+    if (!path.starts_with(API_PREFIX)) {
+        return std::nullopt;
+    }
+    // Параметр начинается после первого '/' за префиксом API
+    const size_t slash = path.find('/', API_PREFIX.size());
+    if (slash == std::string_view::npos) {
+        return std::nullopt;
+    }
+    if (const Route* route = FindRoute(path.substr(0, slash + 1)); route && route->has_param) {
+        return RouteMatch{route, path.substr(slash + 1), {}};
+    }
+    return std::nullopt;
+}
+
+}  // namespace detail
+
+// Ищет маршрут не более чем двумя обращениями к совершенной хеш-таблице, построенной при компиляции
+constexpr std::optional<RouteMatch> MatchRoute(std::string_view target) {
+    if (const size_t question = target.find('?'); question != std::string_view::npos) {
+        if (auto match = detail::MatchPath(target.substr(0, question)); match && match->route->accepts_query) {
+            match->query = target.substr(question + 1);
+            return match;
+        }
+    }
+    // Остальные маршруты сопоставляются со всей целью: у маршрута с параметром строка запроса
+    // остаётся в параметре, и неизвестная карта по-прежнему даёт 404, а не 400
+    return detail::MatchPath(target);
+}
+
+// Значение параметра name из строки запроса вида a=1&b=2. Значения не декодируются
+constexpr std::optional<std::string_view> FindQueryParam(std::string_view query, std::string_view name) {
+    while (!query.empty()) {
+        const size_t amp = query.find('&');
+        const std::string_view param = query.substr(0, amp);
+        if (param.starts_with(name) && param.size() > name.size() && param[name.size()] == '=') {
+            return param.substr(name.size() + 1);
+        }
+        if (amp == std::string_view::npos) {
+            break;
+        }
+        query.remove_prefix(amp + 1);
+    }
+    return std::nullopt;
+}
+
+}  // namespace http_handler
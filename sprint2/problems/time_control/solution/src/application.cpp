@@ -1,11 +1,12 @@
 #include "application.h"
+#include <atomic>
 #include <random>
 #include <utility>
 
 namespace app {
 
 Player::Player(model::GameSession* session, model::Dog* dog, Token token)
-    : dog_{dog}, session_{session}, token_{std::move(token)} {}
+    : dog_{dog}, session_{session}, token_{token} {}
 
 const Token& Player::GetToken() const {
     return token_;
@@ -29,6 +30,7 @@ model::Dog* Player::GetDog() {
 
 
 Player* Players::Add(std::unique_ptr<model::Dog> dog, model::GameSession& session) {
+    std::lock_guard lock{mutex_};
     Token token = GenerateToken();
     
     model::Dog* dog_raw_ptr = dog.get();
@@ -39,36 +41,31 @@ Player* Players::Add(std::unique_ptr<model::Dog> dog, model::GameSession& sessio
     Player* player_raw_ptr = player.get();
     players_.emplace_back(std::move(player));
     
-    token_to_player_[token] = player_raw_ptr;
+    token_to_player_.Insert(token, player_raw_ptr);
     return player_raw_ptr;
 }
 
 Player* Players::FindByToken(const Token& token) {
-    if (auto it = token_to_player_.find(token); it != token_to_player_.end()) {
-        return it->second;
+    if (auto* player = token_to_player_.Find(token)) {
+        return *player;
     }
     return nullptr;
 }
 
 Token Players::GenerateToken() {
-    std::stringstream ss;
-    ss << std::hex << std::setfill('0') << std::setw(16) << generator1_() << std::setw(16) << generator2_();
-    return Token{ss.str()};
+    return Token{generator1_(), generator2_()};
 }
 
-std::vector<model::Dog> Players::GetDogs() const {
-    std::vector<model::Dog> dogs;
-    dogs.reserve(dogs_.size());
-    for(const auto& d_ptr : dogs_){
-        dogs.push_back(*d_ptr);
+Application::Application(model::Game& game, Players& players, net::io_context& ioc)
+    : game_{game}, players_{players}, session_contexts_{&ioc}, strand_{net::make_strand(ioc)} {}
+
+Application::Application(model::Game& game, Players& players, const std::vector<std::unique_ptr<net::io_context>>& contexts)
+    : game_{game}, players_{players}, strand_{net::make_strand(*contexts.at(0))} {
+    for (const auto& context : contexts) {
+        session_contexts_.push_back(context.get());
     }
-    return dogs;
 }
 
-
-Application::Application(model::Game& game, Players& players, net::io_context& ioc)
-    : game_{game}, players_{players}, strand_{net::make_strand(ioc)} {}
-
 const std::vector<model::Map>& Application::ListMaps() const {
     return game_.GetMaps();
 }
@@ -77,21 +74,27 @@ const model::Map* Application::FindMap(const model::Map::Id& id) const {
     return game_.FindMap(id);
 }
 
-std::optional<JoinGameResult> Application::JoinGame(const model::Map::Id& map_id, const std::string& user_name) {
-    const model::Map* map = FindMap(map_id);
-    if (!map) {
-        return std::nullopt;
+model::GameSession* Application::GetSession(const model::Map::Id& map_id) {
+    if (model::GameSession* session = game_.FindSession(map_id)) {
+        return session;
     }
+    return game_.AddSession(map_id);
+}
 
-    model::GameSession* session = game_.FindSession(map_id);
-    if (!session) {
-        session = game_.AddSession(map_id);
+Application::Strand& Application::GetSessionStrand(const model::GameSession& session) {
+    std::lock_guard lock{session_strands_mutex_};
+    if (auto it = session_strands_.find(&session); it != session_strands_.end()) {
+        return it->second;
     }
+    net::io_context& context = *session_contexts_[session_strands_.size() % session_contexts_.size()];
+    return session_strands_.emplace(&session, net::make_strand(context)).first->second;
+}
 
+JoinGameResult Application::JoinGame(model::GameSession& session, const std::string& user_name) {
     auto dog = std::make_unique<model::Dog>(user_name);
-    session->AddDog(dog.get());
+    session.AddDog(dog.get());
     
-    Player* player = players_.Add(std::move(dog), *session);
+    Player* player = players_.Add(std::move(dog), session);
 
     return JoinGameResult{player->GetToken(), player->GetId()};
 }
@@ -126,12 +129,54 @@ void Application::MovePlayer(Player* player, const std::string& move_cmd) {
         direction = "D";
     }
 
-    dog->SetSpeed(speed);
-    dog->SetDirection(direction);
+    player->GetSession()->SetDogMovement(dog, speed, std::move(direction));
+}
+
+void Application::Tick(std::chrono::milliseconds delta, TickHandler on_done) {
+    const std::vector<model::GameSession*> sessions = game_.GetSessions();
+    if (sessions.empty()) {
+        if (on_done) {
+            on_done();
+        }
+        return;
+    }
+
+    // Сессии тикают в своих strand'ах параллельно. Счётчик живёт, пока его держит хотя бы одна задача
+    struct Progress {
+        std::atomic<size_t> remaining;
+        TickHandler on_done;
+    };
+    auto progress = std::make_shared<Progress>();
+    progress->remaining.store(sessions.size(), std::memory_order_relaxed);
+    progress->on_done = std::move(on_done);
+
+    for (model::GameSession* session : sessions) {
+        net::post(GetSessionStrand(*session), [this, session, delta, progress] {
+            session->Tick(delta);
+            if (tick_listener_) {
+                tick_listener_(*session);
+            }
+            // acq_rel: последняя задача видит результаты тиков во всех остальных strand'ах
+            if (progress->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1 && progress->on_done) {
+                progress->on_done();
+            }
+        });
+    }
+}
+
+void Application::StartAutoTick(std::chrono::milliseconds period) {
+    ticker_ = std::make_shared<Ticker>(strand_, period, [this](std::chrono::milliseconds delta, Ticker::Done done) {
+        Tick(delta, std::move(done));
+    });
+    ticker_->Start();
+}
+
+bool Application::IsManualTickAllowed() const noexcept {
+    return !ticker_;
 }
 
-void Application::Tick(std::chrono::milliseconds delta) {
-    game_.Tick(delta);
+void Application::SetTickListener(TickListener listener) {
+    tick_listener_ = std::move(listener);
 }
 
 } // namespace app
\ No newline at end of file
@@ -1,25 +1,23 @@
 #pragma once
 #include "model.h"
-#include "tagged.h"
+#include "ticker.h"
+#include "token.h"
+#include "concurrent_index.h"
 #include <vector>
 #include <random>
-#include <sstream>
-#include <iomanip>
 #include <optional>
 #include <memory>
 #include <chrono>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
 
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/strand.hpp>
+#include <boost/asio/post.hpp>
 
 namespace net = boost::asio;
 
-namespace detail {
-struct TokenTag {};
-}  // namespace detail
-
-using Token = util::Tagged<std::string, detail::TokenTag>;
-
 namespace app {
 
 // Forward declaration
@@ -40,16 +38,18 @@ private:
     Token token_;
 };
 
+// Реестр игроков. Методы можно вызывать из любого потока, поиск по токену не блокируется
 class Players {
 public:
     Player* Add(std::unique_ptr<model::Dog> dog, model::GameSession& session);
     Player* FindByToken(const Token& token);
-    std::vector<model::Dog> GetDogs() const;
 
 private:
+    // Защищает добавление игроков и генераторы токенов
+    mutable std::mutex mutex_;
     std::vector<std::unique_ptr<model::Dog>> dogs_;
     std::vector<std::unique_ptr<Player>> players_;
-    std::unordered_map<Token, Player*, util::TaggedHasher<Token>> token_to_player_;
+    util::ConcurrentIndex<Token, Player*, TokenHasher> token_to_player_;
 
     std::random_device random_device_;
     std::mt19937_64 generator1_{[this] {
@@ -70,24 +70,54 @@ struct JoinGameResult {
     model::Dog::Id player_id;
 };
 
+// Каждая игровая сессия обслуживается в своём strand, поэтому запросы к разным картам
+// выполняются параллельно. Операции с сессией и её собаками (вход в игру, действия игроков,
+// чтение состояния, тик) нужно выполнять в strand этой сессии
 class Application {
 public:
+    using Strand = net::strand<net::io_context::executor_type>;
+    // Вызывается в strand сессии сразу после её тика
+    using TickListener = std::function<void(model::GameSession& session)>;
+    // Вызывается, когда тик выполнен во всех сессиях
+    using TickHandler = std::function<void()>;
+
     explicit Application(model::Game& game, Players& players, net::io_context& ioc);
+    // Strand'ы сессий распределяются по contexts по очереди, strand таймера создаётся в первом из них
+    Application(model::Game& game, Players& players, const std::vector<std::unique_ptr<net::io_context>>& contexts);
 
     const std::vector<model::Map>& ListMaps() const;
     const model::Map* FindMap(const model::Map::Id& id) const;
 
-    std::optional<JoinGameResult> JoinGame(const model::Map::Id& map_id, const std::string& user_name);
+    // Возвращает сессию карты, создавая её при необходимости. Можно вызывать из любого потока
+    model::GameSession* GetSession(const model::Map::Id& map_id);
+    Strand& GetSessionStrand(const model::GameSession& session);
+
+    // Вызывается в strand сессии
+    JoinGameResult JoinGame(model::GameSession& session, const std::string& user_name);
     Player* FindByToken(const Token& token);
+    // Вызывается в strand сессии игрока
     void MovePlayer(Player* player, const std::string& move_cmd);
-    void Tick(std::chrono::milliseconds delta);
-
-    auto& GetStrand() { return strand_; }
+    // Отправляет тик в strand каждой сессии и возвращает управление сразу. on_done вызывается
+    // в strand сессии, закончившей тик последней, или сразу, если сессий нет
+    void Tick(std::chrono::milliseconds delta, TickHandler on_done = {});
+    // Запускает встроенный таймер, продвигающий игровое время с периодом period.
+    // Пока таймер работает, время нельзя продвинуть запросом к API
+    void StartAutoTick(std::chrono::milliseconds period);
+    bool IsManualTickAllowed() const noexcept;
+    // Задаётся до запуска обработки запросов
+    void SetTickListener(TickListener listener);
 
 private:
     model::Game& game_;
     Players& players_;
-    net::strand<net::io_context::executor_type> strand_;
+    // io_context'ы, в которых создаются strand'ы сессий
+    std::vector<net::io_context*> session_contexts_;
+    Strand strand_;
+    std::shared_ptr<Ticker> ticker_;
+    TickListener tick_listener_;
+
+    std::mutex session_strands_mutex_;
+    std::unordered_map<const model::GameSession*, Strand> session_strands_;
 };
 
 } // namespace app
\ No newline at end of file
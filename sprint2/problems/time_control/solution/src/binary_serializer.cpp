@@ -0,0 +1,64 @@
+#include "binary_serializer.h"
+
+#include <cmath>
+#include <cstdint>
+
+namespace binary_serializer {
+
+namespace {
+
+constexpr char FORMAT_VERSION = 1;
+
+void AppendVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out += static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+void AppendSigned(std::string& out, int64_t value) {
+    // zigzag: 0, -1, 1, -2, ... -> 0, 1, 2, 3, ...
+    AppendVarint(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+void AppendFixed(std::string& out, double value) {
+    AppendSigned(out, std::llround(value * POSITION_SCALE));
+}
+
+char EncodeDirection(const std::string& dir) {
+    if (dir == "L") {
+        return 0;
+    }
+    if (dir == "R") {
+        return 1;
+    }
+    if (dir == "D") {
+        return 3;
+    }
+    return 2;
+}
+
+}  // namespace
+
+void AppendGameState(std::string& out, const std::vector<model::Dog*>& dogs) {
+    // Собака с небольшими координатами занимает около 10 байт
+    out.reserve(out.size() + 16 + dogs.size() * 16);
+    out += FORMAT_VERSION;
+    AppendVarint(out, dogs.size());
+
+    uint64_t prev_id = 0;
+    for (const model::Dog* dog : dogs) {
+        const uint64_t id = *dog->GetId();
+        AppendSigned(out, static_cast<int64_t>(id - prev_id));
+        prev_id = id;
+
+        AppendFixed(out, dog->GetPosition().x);
+        AppendFixed(out, dog->GetPosition().y);
+        AppendFixed(out, dog->GetSpeed().u);
+        AppendFixed(out, dog->GetSpeed().v);
+        out += EncodeDirection(dog->GetDirection());
+    }
+}
+
+}  // namespace binary_serializer
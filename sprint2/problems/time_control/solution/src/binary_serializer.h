@@ -0,0 +1,25 @@
+#pragma once
+#include "model.h"
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace binary_serializer {
+
+// Тип содержимого компактного двоичного состояния игры
+constexpr std::string_view DOG_STATE_CONTENT_TYPE = "application/x-dog-state";
+
+// Координаты и скорости передаются в фиксированной точке с шагом 1/POSITION_SCALE
+constexpr double POSITION_SCALE = 1000.0;
+
+// Дописывает в out состояние игры в компактном двоичном виде. Все целые числа кодируются
+// как LEB128 (по 7 бит в байте, младшие байты первыми), знаковые - предварительно в zigzag:
+//   формат (1 байт) = 1
+//   число собак
+//   для каждой собаки:
+//     разность id с предыдущей собакой (zigzag, для первой - с нулём)
+//     x, y, u, v (zigzag, округлённые значения * POSITION_SCALE)
+//     направление (1 байт): 0 - L, 1 - R, 2 - U, 3 - D
+void AppendGameState(std::string& out, const std::vector<model::Dog*>& dogs);
+
+}  // namespace binary_serializer
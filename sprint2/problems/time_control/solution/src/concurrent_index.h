@@ -0,0 +1,118 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace util {
+
+// Хеш-таблица с открытой адресацией, в которую можно только добавлять элементы.
+// Поиск не блокируется и может идти из любого потока одновременно с добавлением,
+// добавления сериализуются мьютексом. При росте таблица копируется в новую вдвое большего
+// размера и публикуется атомарно. Старые таблицы живут до разрушения индекса, так как их
+// может читать начатый ранее поиск. Вместе они занимают не больше новой таблицы
+template <typename Key, typename Value, typename Hasher = std::hash<Key>>
+class ConcurrentIndex {
+public:
+    explicit ConcurrentIndex(size_t initial_capacity = 64) {
+        size_t capacity = 1;
+        while (capacity < initial_capacity) {
+            capacity *= 2;
+        }
+        table_.store(AddTable(capacity), std::memory_order_release);
+    }
+
+    ConcurrentIndex(const ConcurrentIndex&) = delete;
+    ConcurrentIndex& operator=(const ConcurrentIndex&) = delete;
+
+    // Возвращает false, если такой ключ уже есть
+    bool Insert(Key key, Value value) {
+        std::lock_guard lock{write_mutex_};
+        const size_t hash = Hasher{}(key);
+        Table* table = table_.load(std::memory_order_relaxed);
+        if (FindIn(*table, key, hash)) {
+            return false;
+        }
+
+        auto& entry = entries_.emplace_back(std::make_unique<Entry>(Entry{std::move(key), std::move(value), hash}));
+        // Заполненность держим не выше половины, чтобы цепочки проб оставались короткими
+        if ((size_ + 1) * 2 > table->slots.size()) {
+            Table* grown = AddTable(table->slots.size() * 2);
+            for (const auto& slot : table->slots) {
+                if (const Entry* old_entry = slot.load(std::memory_order_relaxed)) {
+                    Place(*grown, old_entry);
+                }
+            }
+            Place(*grown, entry.get());
+            table_.store(grown, std::memory_order_release);
+        } else {
+            Place(*table, entry.get());
+        }
+        ++size_;
+        return true;
+    }
+
+    // Возвращает указатель на значение или nullptr. Указатель действителен до разрушения индекса
+    const Value* Find(const Key& key) const {
+        const Table* table = table_.load(std::memory_order_acquire);
+        const Entry* entry = FindIn(*table, key, Hasher{}(key));
+        return entry ? &entry->value : nullptr;
+    }
+
+    size_t Size() const {
+        std::lock_guard lock{write_mutex_};
+        return size_;
+    }
+
+private:
+    struct Entry {
+        Key key;
+        Value value;
+        size_t hash;
+    };
+
+    struct Table {
+        explicit Table(size_t capacity)
+            : slots(capacity) {
+        }
+
+        std::vector<std::atomic<const Entry*>> slots;
+    };
+
+    Table* AddTable(size_t capacity) {
+        return tables_.emplace_back(std::make_unique<Table>(capacity)).get();
+    }
+
+    static const Entry* FindIn(const Table& table, const Key& key, size_t hash) {
+        const size_t mask = table.slots.size() - 1;
+        for (size_t i = hash & mask;; i = (i + 1) & mask) {
+            const Entry* entry = table.slots[i].load(std::memory_order_acquire);
+            if (!entry) {
+                return nullptr;
+            }
+            if (entry->hash == hash && entry->key == key) {
+                return entry;
+            }
+        }
+    }
+
+    // Вызывается под write_mutex_. Запись с release публикует содержимое Entry читателям
+    static void Place(Table& table, const Entry* entry) {
+        const size_t mask = table.slots.size() - 1;
+        size_t i = entry->hash & mask;
+        while (table.slots[i].load(std::memory_order_relaxed)) {
+            i = (i + 1) & mask;
+        }
+        table.slots[i].store(entry, std::memory_order_release);
+    }
+
+    std::atomic<Table*> table_;
+    mutable std::mutex write_mutex_;
+    std::vector<std::unique_ptr<Table>> tables_;
+    std::vector<std::unique_ptr<Entry>> entries_;
+    size_t size_ = 0;
+};
+
+}  // namespace util
@@ -0,0 +1,131 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace http_handler {
+
+namespace detail {
+
+constexpr char ToLower(char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+constexpr bool EqualsIgnoreCase(std::string_view lhs, std::string_view rhs) {
+    if (lhs.size() != rhs.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < lhs.size(); ++i) {
+        if (ToLower(lhs[i]) != ToLower(rhs[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+constexpr std::string_view TrimSpaces(std::string_view str) {
+    while (!str.empty() && (str.front() == ' ' || str.front() == '\t')) {
+        str.remove_prefix(1);
+    }
+    while (!str.empty() && (str.back() == ' ' || str.back() == '\t')) {
+        str.remove_suffix(1);
+    }
+    return str;
+}
+
+// Вес вида "0.5". Значения больше 1 считаются равными 1. nullopt - вес некорректен
+constexpr std::optional<double> ParseQValue(std::string_view text) {
+    const size_t dot = text.find('.');
+    const std::string_view integer = text.substr(0, dot);
+    const std::string_view fraction = dot == std::string_view::npos ? std::string_view{} : text.substr(dot + 1);
+    auto is_digits = [](std::string_view digits) {
+        for (char c : digits) {
+            if (c < '0' || c > '9') {
+                return false;
+            }
+        }
+        return true;
+    };
+    if (integer.empty() || !is_digits(integer) || !is_digits(fraction)) {
+        return std::nullopt;
+    }
+    if (integer.find_first_not_of('0') != std::string_view::npos) {
+        return 1.0;
+    }
+    // Дробная часть делится на степень 10 один раз, поэтому "0.3" даёт ровно 0.3.
+    // Цифры после 18-й на вес не влияют
+    uint64_t numerator = 0;
+    uint64_t denominator = 1;
+    for (char c : fraction.substr(0, 18)) {
+        numerator = numerator * 10 + static_cast<uint64_t>(c - '0');
+        denominator *= 10;
+    }
+    return static_cast<double>(numerator) / static_cast<double>(denominator);
+}
+
+// Вес элемента заголовка Accept или Accept-Encoding по его параметрам вида "q=0.5; level=1".
+// Без параметра q, как и при некорректном весе, элемент получает вес 1
+constexpr double GetQuality(std::string_view params) {
+    while (!params.empty()) {
+        const size_t semicolon = params.find(';');
+        const std::string_view param = TrimSpaces(params.substr(0, semicolon));
+        if (param.size() >= 2 && ToLower(param[0]) == 'q' && param[1] == '=') {
+            return ParseQValue(param.substr(2)).value_or(1.0);
+        }
+        if (semicolon == std::string_view::npos) {
+            break;
+        }
+        params.remove_prefix(semicolon + 1);
+    }
+    return 1.0;
+}
+
+}  // namespace detail
+
+// Перечислен ли тип type в заголовке Accept явно и без q=0. Шаблоны вида */* не учитываются:
+// нестандартные представления отдаются только клиентам, которые запросили их сами
+constexpr bool AcceptsMediaType(std::string_view accept, std::string_view type) {
+    while (!accept.empty()) {
+        const size_t comma = accept.find(',');
+        const std::string_view range = accept.substr(0, comma);
+        const size_t semicolon = range.find(';');
+        if (detail::EqualsIgnoreCase(detail::TrimSpaces(range.substr(0, semicolon)), type)) {
+            return semicolon == std::string_view::npos || detail::GetQuality(range.substr(semicolon + 1)) > 0.0;
+        }
+        if (comma == std::string_view::npos) {
+            break;
+        }
+        accept.remove_prefix(comma + 1);
+    }
+    return false;
+}
+
+// Вес кодирования coding в заголовке Accept-Encoding. Не упомянутое кодирование получает вес "*",
+// а identity без "*" допустимо всегда. Пустой заголовок допускает только identity
+constexpr double GetEncodingQuality(std::string_view accept_encoding, std::string_view coding) {
+    std::optional<double> any_quality;
+    while (!accept_encoding.empty()) {
+        const size_t comma = accept_encoding.find(',');
+        const std::string_view element = accept_encoding.substr(0, comma);
+        const size_t semicolon = element.find(';');
+        const std::string_view name = detail::TrimSpaces(element.substr(0, semicolon));
+        const double quality = semicolon == std::string_view::npos ? 1.0 : detail::GetQuality(element.substr(semicolon + 1));
+
+        if (detail::EqualsIgnoreCase(name, coding)) {
+            return quality;
+        }
+        if (name == "*") {
+            any_quality = quality;
+        }
+        if (comma == std::string_view::npos) {
+            break;
+        }
+        accept_encoding.remove_prefix(comma + 1);
+    }
+    if (any_quality) {
+        return *any_quality;
+    }
+    return coding == "identity" ? 1.0 : 0.0;
+}
+
+}  // namespace http_handler
@@ -0,0 +1,128 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace http_server {
+
+// Память для асинхронных операций одного соединения. Чтение, запись и передача ответа
+// в соединение идут одновременно, поэтому слотов несколько. Слот освобождается до вызова
+// обработчика, возможно в другом потоке, поэтому занятость слота атомарна.
+// Операция, которой не хватило свободного слота, получает память из кучи
+class HandlerMemory {
+public:
+    static constexpr std::size_t SLOT_SIZE = 1024;
+    static constexpr std::size_t SLOT_COUNT = 4;
+
+    HandlerMemory() = default;
+    HandlerMemory(const HandlerMemory&) = delete;
+    HandlerMemory& operator=(const HandlerMemory&) = delete;
+
+    void* Allocate(std::size_t size) {
+        if (size <= SLOT_SIZE) {
+            for (Slot& slot : slots_) {
+                if (!slot.in_use.exchange(true, std::memory_order_acquire)) {
+                    return slot.storage;
+                }
+            }
+        }
+        return ::operator new(size);
+    }
+
+    void Deallocate(void* p) noexcept {
+        for (Slot& slot : slots_) {
+            if (p == slot.storage) {
+                slot.in_use.store(false, std::memory_order_release);
+                return;
+            }
+        }
+        ::operator delete(p);
+    }
+
+private:
+    struct Slot {
+        alignas(std::max_align_t) std::byte storage[SLOT_SIZE];
+        std::atomic<bool> in_use{false};
+    };
+
+    std::array<Slot, SLOT_COUNT> slots_;
+};
+
+// Аллокатор операций соединения. Владеет памятью совместно с соединением: при остановке
+// io_context операция может освободить память уже после разрушения соединения
+template <typename T>
+class HandlerAllocator {
+public:
+    using value_type = T;
+
+    explicit HandlerAllocator(std::shared_ptr<HandlerMemory> memory) noexcept
+        : memory_(std::move(memory)) {
+    }
+    template <typename U>
+    HandlerAllocator(const HandlerAllocator<U>& other) noexcept
+        : memory_(other.memory_) {
+    }
+
+    T* allocate(std::size_t n) {
+        if constexpr (alignof(T) > alignof(std::max_align_t)) {
+            return std::allocator<T>{}.allocate(n);
+        } else {
+            return static_cast<T*>(memory_->Allocate(n * sizeof(T)));
+        }
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        if constexpr (alignof(T) > alignof(std::max_align_t)) {
+            std::allocator<T>{}.deallocate(p, n);
+        } else {
+            memory_->Deallocate(p);
+        }
+    }
+
+    template <typename U>
+    bool operator==(const HandlerAllocator<U>& other) const noexcept {
+        return memory_ == other.memory_;
+    }
+
+private:
+    template <typename U>
+    friend class HandlerAllocator;
+
+    std::shared_ptr<HandlerMemory> memory_;
+};
+
+// Обработчик, операции которого Asio и Beast размещают в памяти соединения
+template <typename Handler>
+class MemoryBoundHandler {
+public:
+    using allocator_type = HandlerAllocator<std::byte>;
+
+    MemoryBoundHandler(const std::shared_ptr<HandlerMemory>& memory, Handler handler)
+        : memory_(memory)
+        , handler_(std::move(handler)) {
+    }
+
+    allocator_type get_allocator() const noexcept {
+        return allocator_type{memory_};
+    }
+
+    template <typename... Args>
+    void operator()(Args&&... args) {
+        handler_(std::forward<Args>(args)...);
+    }
+
+private:
+    std::shared_ptr<HandlerMemory> memory_;
+    Handler handler_;
+};
+
+template <typename Handler>
+MemoryBoundHandler<std::decay_t<Handler>> BindHandlerMemory(const std::shared_ptr<HandlerMemory>& memory, Handler&& handler) {
+    return {memory, std::forward<Handler>(handler)};
+}
+
+}  // namespace http_server
@@ -0,0 +1,181 @@
+#pragma once
+#include "message_allocator.h"
+#include <boost/asio/buffer.hpp>
+#include <boost/beast/core/error.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/optional.hpp>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace http_handler {
+
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace net = boost::asio;
+
+// Тело ответа, разделяющее неизменяемый буфер между всеми ответами без копирования.
+// Пустой указатель означает ответ без тела (например, на HEAD)
+struct SharedStringBody {
+    using value_type = std::shared_ptr<const std::string>;
+    // Такие ответы соединение может отправлять пачкой вместе с соседними
+    static constexpr bool is_in_memory = true;
+
+    static std::uint64_t size(const value_type& body) {
+        return body ? body->size() : 0;
+    }
+
+    class writer {
+    public:
+        using const_buffers_type = net::const_buffer;
+
+        template <bool isRequest, class Fields>
+        writer(const http::header<isRequest, Fields>&, const value_type& body)
+            : body_{body} {
+        }
+
+        void init(beast::error_code& ec) {
+            ec = {};
+        }
+
+        boost::optional<std::pair<const_buffers_type, bool>> get(beast::error_code& ec) {
+            ec = {};
+            if (!body_ || body_->empty()) {
+                return boost::none;
+            }
+            return {{net::const_buffer{body_->data(), body_->size()}, false}};
+        }
+
+    private:
+        const value_type& body_;
+    };
+};
+
+using SharedStringResponse = http::response<SharedStringBody, http_server::ResponseFields>;
+
+// Значение заголовка без временной std::string
+inline beast::string_view ToHeaderValue(std::string_view value) noexcept {
+    return {value.data(), value.size()};
+}
+
+// Сильный ETag, зависящий только от содержимого
+inline std::string MakeStrongETag(std::string_view content) {
+    // FNV-1a
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (char c : content) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001B3ull;
+    }
+    constexpr char DIGITS[] = "0123456789abcdef";
+    std::string etag(18, '"');
+    for (int i = 16; i > 0; --i, hash >>= 4) {
+        etag[i] = DIGITS[hash & 0xF];
+    }
+    return etag;
+}
+
+// Дата в формате IMF-fixdate для Last-Modified: "Sun, 06 Nov 1994 08:49:37 GMT"
+inline std::string FormatHttpDate(std::chrono::sys_seconds time) {
+    using namespace std::chrono;
+    constexpr const char* WEEKDAYS[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+    constexpr const char* MONTHS[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+
+    const sys_days day = floor<days>(time);
+    const year_month_day date{day};
+    const hh_mm_ss clock{time - day};
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%s, %02u %s %04d %02d:%02d:%02d GMT",
+                  WEEKDAYS[weekday{day}.c_encoding()], static_cast<unsigned>(date.day()),
+                  MONTHS[static_cast<unsigned>(date.month()) - 1], static_cast<int>(date.year()),
+                  static_cast<int>(clock.hours().count()), static_cast<int>(clock.minutes().count()),
+                  static_cast<int>(clock.seconds().count()));
+    return buffer;
+}
+
+// Разбирает дату в формате IMF-fixdate. Устаревшие форматы RFC 850 и asctime не поддерживаются:
+// заголовок с такой датой просто игнорируется
+inline std::optional<std::chrono::sys_seconds> ParseHttpDate(std::string_view text) {
+    using namespace std::chrono;
+    constexpr std::string_view MONTHS = "JanFebMarAprMayJunJulAugSepOctNovDec";
+
+    if (text.size() != 29 || text.substr(3, 2) != ", " || text[7] != ' ' || text[11] != ' ' || text[16] != ' '
+        || text[19] != ':' || text[22] != ':' || text.substr(25) != " GMT") {
+        return std::nullopt;
+    }
+    bool valid = true;
+    auto number = [&](size_t pos, size_t length) {
+        int value = 0;
+        for (char c : text.substr(pos, length)) {
+            valid = valid && c >= '0' && c <= '9';
+            value = value * 10 + (c - '0');
+        }
+        return value;
+    };
+    const size_t month = MONTHS.find(text.substr(8, 3));
+    const year_month_day date{year{number(12, 4)}, std::chrono::month{static_cast<unsigned>(month / 3 + 1)},
+                              std::chrono::day{static_cast<unsigned>(number(5, 2))}};
+    const int h = number(17, 2);
+    const int m = number(20, 2);
+    const int s = number(23, 2);
+    if (!valid || month == std::string_view::npos || month % 3 != 0 || !date.ok() || h > 23 || m > 59 || s > 60) {
+        return std::nullopt;
+    }
+    return sys_days{date} + hours{h} + minutes{m} + seconds{s};
+}
+
+// Проверяет, совпадает ли какой-либо из ETag заголовка If-None-Match с etag.
+// Для If-None-Match используется слабое сравнение, поэтому префикс W/ игнорируется
+inline bool IfNoneMatchHits(std::string_view if_none_match, std::string_view etag) {
+    auto trim = [](std::string_view s) {
+        while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) {
+            s.remove_prefix(1);
+        }
+        while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) {
+            s.remove_suffix(1);
+        }
+        return s;
+    };
+
+    if (trim(if_none_match) == "*") {
+        return true;
+    }
+    while (!if_none_match.empty()) {
+        const size_t comma = if_none_match.find(',');
+        std::string_view candidate = trim(if_none_match.substr(0, comma));
+        if (candidate.starts_with("W/")) {
+            candidate.remove_prefix(2);
+        }
+        if (candidate == etag) {
+            return true;
+        }
+        if (comma == std::string_view::npos) {
+            break;
+        }
+        if_none_match.remove_prefix(comma + 1);
+    }
+    return false;
+}
+
+// Есть ли у клиента актуальная копия представления с etag, изменённого в last_modified.
+// If-Modified-Since учитывается только при отсутствии If-None-Match (RFC 9110, 13.2.2)
+inline bool IsNotModified(std::optional<std::string_view> if_none_match,
+                          std::optional<std::string_view> if_modified_since, std::string_view etag,
+                          std::chrono::sys_seconds last_modified) {
+    if (if_none_match) {
+        if (etag.starts_with("W/")) {
+            etag.remove_prefix(2);
+        }
+        return IfNoneMatchHits(*if_none_match, etag);
+    }
+    if (if_modified_since) {
+        const auto since = ParseHttpDate(*if_modified_since);
+        return since && last_modified <= *since;
+    }
+    return false;
+}
+
+}  // namespace http_handler
@@ -0,0 +1,146 @@
+#include "http_range.h"
+#include "content_negotiation.h"
+#include <limits>
+
+namespace http_handler {
+
+namespace {
+
+// Непустая последовательность цифр. Слишком большие числа насыщаются до максимума:
+// такие позиции всё равно лежат за концом любого файла
+std::optional<uint64_t> ParsePosition(std::string_view digits) {
+    if (digits.empty()) {
+        return std::nullopt;
+    }
+    constexpr uint64_t MAX = std::numeric_limits<uint64_t>::max();
+    uint64_t value = 0;
+    for (char c : digits) {
+        if (c < '0' || c > '9') {
+            return std::nullopt;
+        }
+        const uint64_t digit = static_cast<uint64_t>(c - '0');
+        value = value > (MAX - digit) / 10 ? MAX : value * 10 + digit;
+    }
+    return value;
+}
+
+}  // namespace
+
+std::optional<std::vector<ByteRange>> ParseRange(std::string_view range, uint64_t size) {
+    using namespace std::literals;
+    constexpr auto UNIT = "bytes="sv;
+    if (range.size() < UNIT.size() || !detail::EqualsIgnoreCase(range.substr(0, UNIT.size()), UNIT)) {
+        return std::nullopt;
+    }
+    range.remove_prefix(UNIT.size());
+
+    std::vector<ByteRange> ranges;
+    size_t count = 0;
+    while (!range.empty()) {
+        const size_t comma = range.find(',');
+        const std::string_view spec = detail::TrimSpaces(range.substr(0, comma));
+        range = comma == std::string_view::npos ? std::string_view{} : range.substr(comma + 1);
+        if (spec.empty()) {
+            // Пустые элементы списка допускаются
+            continue;
+        }
+        if (++count > MAX_BYTE_RANGES) {
+            return std::nullopt;
+        }
+        const size_t dash = spec.find('-');
+        if (dash == std::string_view::npos) {
+            return std::nullopt;
+        }
+        const std::string_view first_text = spec.substr(0, dash);
+        const std::string_view last_text = spec.substr(dash + 1);
+
+        if (first_text.empty()) {
+            // Суффикс "-n": последние n байт
+            const auto length = ParsePosition(last_text);
+            if (!length) {
+                return std::nullopt;
+            }
+            if (*length > 0 && size > 0) {
+                ranges.push_back({size - std::min(*length, size), size - 1});
+            }
+            continue;
+        }
+
+        const auto first = ParsePosition(first_text);
+        const auto last = last_text.empty() ? std::optional{std::numeric_limits<uint64_t>::max()}
+                                            : ParsePosition(last_text);
+        if (!first || !last || *last < *first) {
+            return std::nullopt;
+        }
+        if (*first < size) {
+            ranges.push_back({*first, std::min(*last, size - 1)});
+        }
+    }
+    if (count == 0) {
+        return std::nullopt;
+    }
+    return ranges;
+}
+
+bool IfRangeMatches(std::string_view if_range, std::string_view etag, std::chrono::sys_seconds last_modified) {
+    if_range = detail::TrimSpaces(if_range);
+    if (if_range.starts_with('"') || if_range.starts_with("W/")) {
+        return if_range == etag && !etag.starts_with("W/");
+    }
+    const auto date = ParseHttpDate(if_range);
+    return date && *date == last_modified;
+}
+
+std::string MakeContentRange(const ByteRange& range, uint64_t size) {
+    return "bytes " + std::to_string(range.first) + '-' + std::to_string(range.last) + '/' + std::to_string(size);
+}
+
+std::uint64_t ByteRangesBody::size(const value_type& body) {
+    uint64_t total = 0;
+    for (const auto& range : body.ranges) {
+        total += range.GetSize();
+    }
+    for (const auto& separator : body.separators) {
+        total += separator.size();
+    }
+    return total;
+}
+
+boost::optional<std::pair<ByteRangesBody::writer::const_buffers_type, bool>> ByteRangesBody::writer::get(
+    beast::error_code& ec) {
+    ec = {};
+    // Без разделителей части идут подряд, иначе разделитель стоит перед каждой частью и в конце
+    const bool multipart = !body_.separators.empty();
+    const size_t count = multipart ? body_.ranges.size() * 2 + 1 : body_.ranges.size();
+    if (!body_.source || piece_ >= count) {
+        return boost::none;
+    }
+    const size_t piece = piece_++;
+    const bool more = piece_ < count;
+    if (multipart && piece % 2 == 0) {
+        const std::string& separator = body_.separators[piece / 2];
+        return {{const_buffers_type{separator.data(), separator.size()}, more}};
+    }
+    const ByteRange& range = body_.ranges[multipart ? piece / 2 : piece];
+    return {{const_buffers_type{body_.source->data() + range.first, static_cast<size_t>(range.GetSize())}, more}};
+}
+
+ByteRangesBody::value_type MakeMultipartRanges(std::shared_ptr<const std::string> source,
+                                               std::vector<ByteRange> ranges, std::string_view content_type,
+                                               std::string_view boundary) {
+    ByteRangesBody::value_type body{std::move(source), std::move(ranges), {}};
+    body.separators.reserve(body.ranges.size() + 1);
+    for (const auto& range : body.ranges) {
+        std::string separator;
+        if (!body.separators.empty()) {
+            separator += "\r\n";
+        }
+        separator.append("--").append(boundary).append("\r\nContent-Type: ").append(content_type);
+        separator.append("\r\nContent-Range: ").append(MakeContentRange(range, body.source->size())).append("\r\n\r\n");
+        body.separators.push_back(std::move(separator));
+    }
+    body.separators.push_back(std::string{"\r\n--"}.append(boundary).append("--\r\n"));
+    return body;
+}
+
+}  // namespace http_handler
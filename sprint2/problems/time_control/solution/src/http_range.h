@@ -0,0 +1,86 @@
+#pragma once
+#include "http_cache.h"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace http_handler {
+
+// Диапазон байт [first, last] включительно, как в заголовке Range
+struct ByteRange {
+    uint64_t first = 0;
+    uint64_t last = 0;
+
+    uint64_t GetSize() const noexcept {
+        return last - first + 1;
+    }
+
+    bool operator==(const ByteRange&) const = default;
+};
+
+// Больше диапазонов в одном запросе не обслуживается: ответ на такой Range - всё представление
+inline constexpr size_t MAX_BYTE_RANGES = 16;
+
+// Разбирает заголовок Range для представления размером size. Диапазоны обрезаются
+// по размеру, непересекающиеся с представлением отбрасываются.
+// nullopt - заголовок нужно проигнорировать и отдать представление целиком: он некорректен,
+// задаёт не байты или слишком много диапазонов. Пустой список - ни один диапазон
+// не пересекается с представлением (416 Range Not Satisfiable)
+std::optional<std::vector<ByteRange>> ParseRange(std::string_view range, uint64_t size);
+
+// Относится ли Range к текущему представлению. If-Range содержит либо ETag, который
+// сравнивается строго (слабый ETag не подходит), либо дату последнего изменения
+bool IfRangeMatches(std::string_view if_range, std::string_view etag, std::chrono::sys_seconds last_modified);
+
+// Значение Content-Range для части ответа 206: "bytes first-last/size"
+std::string MakeContentRange(const ByteRange& range, uint64_t size);
+
+// Тело ответа 206 из частей общего неизменяемого буфера без копирования.
+// Части нескольких диапазонов разделяются заголовками multipart/byteranges
+struct ByteRangesBody {
+    struct value_type {
+        std::shared_ptr<const std::string> source;
+        std::vector<ByteRange> ranges;
+        // Пусто для одного диапазона. Иначе separators[i] предшествует ranges[i],
+        // а последний разделитель завершает тело
+        std::vector<std::string> separators;
+    };
+    static constexpr bool is_in_memory = true;
+
+    static std::uint64_t size(const value_type& body);
+
+    class writer {
+    public:
+        using const_buffers_type = net::const_buffer;
+
+        template <bool isRequest, class Fields>
+        writer(const http::header<isRequest, Fields>&, const value_type& body)
+            : body_{body} {
+        }
+
+        void init(beast::error_code& ec) {
+            ec = {};
+        }
+
+        boost::optional<std::pair<const_buffers_type, bool>> get(beast::error_code& ec);
+
+    private:
+        const value_type& body_;
+        size_t piece_ = 0;
+    };
+};
+
+using ByteRangesResponse = http::response<ByteRangesBody, http_server::ResponseFields>;
+
+// Тело multipart/byteranges с частями ranges из source. Каждая часть получает
+// заголовки Content-Type и Content-Range. Content-Type самого ответа -
+// "multipart/byteranges; boundary=" + boundary
+ByteRangesBody::value_type MakeMultipartRanges(std::shared_ptr<const std::string> source,
+                                               std::vector<ByteRange> ranges, std::string_view content_type,
+                                               std::string_view boundary);
+
+}  // namespace http_handler
@@ -1,5 +1,7 @@
 #include "http_server.h"
 
+#include <span>
+
 namespace http_server {
 
 void ReportError(beast::error_code ec, std::string_view what) {
@@ -8,6 +10,7 @@ void ReportError(beast::error_code ec, std::string_view what) {
 
 SessionBase::SessionBase(tcp::socket&& socket) 
     : stream_(std::move(socket)) {
+    write_buffers_.reserve(MAX_WRITE_BATCH * 4);
 }
 
 void SessionBase::Run() {
@@ -18,41 +21,106 @@ void SessionBase::Run() {
 }
 
 void SessionBase::Read() {
-    // Очищаем запрос от прежнего значения (метод Read может быть вызван несколько раз)
-    request_ = {};
+    if (reading_ || read_done_ || closed_ || GetUnansweredCount() >= MAX_PIPELINED_REQUESTS) {
+        return;
+    }
+    reading_ = true;
+    // Каждый запрос разбирается новым парсером (метод Read может быть вызван несколько раз)
+    parser_.emplace();
     stream_.expires_after(30s);
-    // Считываем request_ из stream_, используя buffer_ для хранения считанных данных
-    http::async_read(stream_, buffer_, request_,
+    // Считываем запрос из stream_, используя buffer_ для хранения считанных данных
+    http::async_read(stream_, buffer_, *parser_,
                         // По окончании операции будет вызван метод OnRead
-                        beast::bind_front_handler(&SessionBase::OnRead, GetSharedThis()));
+                        BindHandlerMemory(handler_memory_, beast::bind_front_handler(&SessionBase::OnRead, GetSharedThis())));
 }
 
-void SessionBase::OnRead(beast::error_code ec, std::size_t bytes_read) {
+void SessionBase::OnRead(beast::error_code ec, [[maybe_unused]] std::size_t bytes_read) {
+    reading_ = false;
+    if (closed_) {
+        return;
+    }
     if (ec == http::error::end_of_stream) {
-        // Нормальная ситуация - клиент закрыл соединение
-        return Close();
+        // Нормальная ситуация - клиент закрыл соединение. Ответы на прочитанные запросы отправляем
+        read_done_ = true;
+        if (GetUnansweredCount() == 0) {
+            Close();
+        }
+        return;
     }
     if (ec) {
+        read_done_ = true;
         return ReportError(ec, "read"sv);
     }
-    HandleRequest(std::move(request_));
+
+    HttpRequest request = parser_->release();
+    // После запроса на закрытие или смену протокола запросов по HTTP больше не будет
+    if (!request.keep_alive() || websocket::is_upgrade(request)) {
+        read_done_ = true;
+    }
+    HandleRequest(std::move(request), next_request_id_++);
+    // Следующий запрос читаем, не дожидаясь ответа на этот
+    Read();
+}
+
+void SessionBase::WriteNext() {
+    if (writing_count_ > 0 || closed_ || !responses_.IsReady(0)) {
+        return;
+    }
+
+    if (responses_.Get(0).TakeOver(stream_)) {
+        // Соединением теперь владеет другой протокол
+        closed_ = true;
+        responses_.Clear();
+        return;
+    }
+
+    // Собираем подряд идущие готовые ответы в одну запись
+    write_buffers_.clear();
+    bool close = false;
+    while (!close && writing_count_ < MAX_WRITE_BATCH && responses_.IsReady(writing_count_)
+           && responses_.Get(writing_count_).AppendBuffers(write_buffers_)) {
+        close = responses_.Get(writing_count_).NeedEof();
+        ++writing_count_;
+    }
+
+    if (writing_count_ > 0) {
+        // span не копирует вектор буферов, в отличие от передачи самого вектора
+        net::async_write(stream_, std::span<const net::const_buffer>{write_buffers_},
+                         BindHandlerMemory(handler_memory_, [self = GetSharedThis(), close](beast::error_code ec, std::size_t bytes_written) {
+                             self->OnWrite(close, ec, bytes_written);
+                         }));
+        return;
+    }
+
+    // Ответ, который нельзя собрать заранее (например, файл), записывается отдельно
+    close = responses_.Get(0).NeedEof();
+    writing_count_ = 1;
+    responses_.Get(0).AsyncWrite(stream_, [self = GetSharedThis(), close](beast::error_code ec, std::size_t bytes_written) {
+        self->OnWrite(close, ec, bytes_written);
+    });
 }
 
 void SessionBase::OnWrite(bool close, beast::error_code ec, [[maybe_unused]] std::size_t bytes_written) {
+    responses_.Release(writing_count_);
+    writing_count_ = 0;
     if (ec) {
+        closed_ = true;
         return ReportError(ec, "write"sv);
     }
 
-    if (close) {
-        // Семантика ответа требует закрыть соединение
+    if (close || (read_done_ && GetUnansweredCount() == 0)) {
+        // Семантика ответа требует закрыть соединение, либо ответы на все запросы отправлены
         return Close();
     }
 
-    // Считываем следующий запрос
+    WriteNext();
+    // Чтение могло остановиться из-за слишком большого числа запросов без ответа
     Read();
 }
 
 void SessionBase::Close() {
+    closed_ = true;
+    responses_.Clear();
     beast::error_code ec;
     stream_.socket().shutdown(tcp::socket::shutdown_send, ec);
     // Если при закрытии сокета произошла ошибка, логируем
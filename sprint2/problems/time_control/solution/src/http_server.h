@@ -1,6 +1,15 @@
 #pragma once
 #include "sdk.h"
+#include "handler_memory.h"
+#include "message_allocator.h"
+#include "response_queue.h"
+#include "websocket_session.h"
+#include <cstdint>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <vector>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/strand.hpp>
 #include <boost/beast/core.hpp>
@@ -18,12 +27,22 @@ using namespace std::literals;
 
 using StringRequest = http::request<http::string_body>;
 using StringResponse = http::response<http::string_body>;
-using HttpRequest = StringRequest; // Используем StringRequest как основной тип запроса
+// Запрос читается в память пула, поэтому заголовки keep-alive запросов
+// размещаются в блоках, освобождённых предыдущими запросами
+using HttpRequest = http::request<RequestBody, RequestFields>;
 
 
 void ReportError(beast::error_code ec, std::string_view what);
 
 
+// Соединение поддерживает конвейерную обработку HTTP/1.1: следующие запросы читаются,
+// не дожидаясь ответов на предыдущие, а ответы отправляются строго в порядке запросов.
+// Готовые ответы из памяти отправляются вместе одной операцией записи.
+// Память под ответы в очереди переиспользуется, а асинхронные операции размещаются
+// в HandlerMemory соединения, поэтому после прогрева чтение запроса и отправка ответа,
+// собранного в памяти с заголовками в ResponseFields, обращаются к куче не больше раза:
+// обработчик таймера tcp_stream Beast размещает сам.
+// Обработчик запроса, ответы-файлы и WebSocket могут выделять память
 class SessionBase {
 public:
     // Запрещаем копирование и присваивание объектов SessionBase и его наследников
@@ -33,9 +52,18 @@ public:
     void Run();
 
 protected:
+    // Наибольшее число запросов, ответы на которые ещё не отправлены.
+    // Дальше соединение перестаёт читать запросы, пока не отправит ответы
+    static constexpr uint64_t MAX_PIPELINED_REQUESTS = ResponseQueue::CAPACITY;
+    // Наибольшее число ответов, отправляемых одной операцией записи
+    static constexpr size_t MAX_WRITE_BATCH = 16;
+
     beast::tcp_stream stream_;
     beast::flat_buffer buffer_;
-    HttpRequest request_;
+    // Память операций чтения, записи и передачи ответов в соединение
+    std::shared_ptr<HandlerMemory> handler_memory_ = std::make_shared<HandlerMemory>();
+    // Парсер принадлежит соединению: http::async_read с сообщением выделял бы парсер в куче на каждый запрос
+    std::optional<http::request_parser<RequestBody, RequestFields::allocator_type>> parser_;
 
     explicit SessionBase(tcp::socket&& socket);
     ~SessionBase() = default;
@@ -45,22 +73,52 @@ protected:
     void OnWrite(bool close, beast::error_code ec, [[maybe_unused]] std::size_t bytes_written);
     void Close();
 
+    // Ответ на запрос с номером request_id. Можно вызывать из любого потока
     template <typename Body, typename Fields>
-    void Write(http::response<Body, Fields>&& response) {
-        // Запись выполняется асинхронно, поэтому response перемещаем в область кучи
-        auto safe_response = std::make_shared<http::response<Body, Fields>>(std::move(response));
-
-        auto self = GetSharedThis();
-        // Захватываем safe_response, чтобы он жил до конца операции записи
-        http::async_write(stream_, *safe_response,
-                          [safe_response, self](beast::error_code ec, std::size_t bytes_written) {
-                              self->OnWrite(safe_response->need_eof(), ec, bytes_written);
-                          });
+    void Write(uint64_t request_id, http::response<Body, Fields>&& response) {
+        // Очередь меняется только в executor потока, поэтому ответ переносится туда
+        net::dispatch(stream_.get_executor(),
+                      BindHandlerMemory(handler_memory_, [self = GetSharedThis(), request_id, response = std::move(response)]() mutable {
+                          if (!self->closed_) {
+                              self->responses_.Emplace<detail::PendingResponse<Body, Fields>>(request_id, std::move(response));
+                              self->WriteNext();
+                          }
+                      }));
+    }
+
+    // Соединение переходит на WebSocket после отправки ответов на предыдущие запросы
+    void Write(uint64_t request_id, WebSocketAccept&& accept) {
+        auto ws_session = std::make_shared<WebSocketSession>(stream_.get_executor());
+        accept.on_session(ws_session);
+        net::dispatch(stream_.get_executor(),
+                      [self = GetSharedThis(), request_id, ws_session = std::move(ws_session), request = std::move(accept.request)]() mutable {
+                          if (!self->closed_) {
+                              self->responses_.Emplace<detail::PendingUpgrade>(request_id, std::move(ws_session), std::move(request));
+                              self->WriteNext();
+                          }
+                      });
     }
 
     // Обработку запроса делегируем подклассу
-    virtual void HandleRequest(HttpRequest&& request) = 0;
+    virtual void HandleRequest(HttpRequest&& request, uint64_t request_id) = 0;
     virtual std::shared_ptr<SessionBase> GetSharedThis() = 0;
+
+private:
+    void WriteNext();
+    uint64_t GetUnansweredCount() const noexcept {
+        return next_request_id_ - responses_.GetFirstId();
+    }
+
+    // Поля ниже используются только в executor потока stream_
+    uint64_t next_request_id_ = 0;
+    ResponseQueue responses_;
+    // Число первых ответов очереди, которые записываются сейчас, и их буферы
+    uint64_t writing_count_ = 0;
+    std::vector<net::const_buffer> write_buffers_;
+    bool reading_ = false;
+    // Новых запросов не будет: клиент закрыл соединение или попросил его закрыть
+    bool read_done_ = false;
+    bool closed_ = false;
 };
 
 
@@ -78,13 +136,13 @@ private:
         return this->shared_from_this();
     }
 
-    void HandleRequest(HttpRequest&& request) override {
+    void HandleRequest(HttpRequest&& request, uint64_t request_id) override {
         // Захватываем умный указатель на текущий объект Session в лямбде,
         // чтобы продлить время жизни сессии до вызова лямбды.
         // Используется generic-лямбда функция, способная принять response произвольного типа
         auto remote_ep = this->stream_.socket().remote_endpoint();
-        request_handler_(std::move(request), [self = this->shared_from_this()](auto&& response) {
-            self->Write(std::move(response));
+        request_handler_(std::move(request), [self = this->shared_from_this(), request_id](auto&& response) {
+            self->Write(request_id, std::move(response));
         }, remote_ep);
     }
 
@@ -92,14 +150,27 @@ private:
 };
 
 
+// Как Listener распределяет соединения по потокам
+enum class ListenMode {
+    // Один io_context выполняется во всех потоках. Acceptor и каждое соединение
+    // работают в своём strand
+    SHARED,
+    // io_context выполняется в одном потоке и принимает соединения своим сокетом
+    // с SO_REUSEPORT, а ядро распределяет соединения между такими сокетами.
+    // Соединения не покидают поток, поэтому strand им не нужен
+    PER_THREAD,
+};
+
+
 template <typename RequestHandler>
 class Listener : public std::enable_shared_from_this<Listener<RequestHandler>> {
 public:
     template <typename Handler>
-    Listener(net::io_context& ioc, const tcp::endpoint& endpoint, Handler&& request_handler)
+    Listener(net::io_context& ioc, const tcp::endpoint& endpoint, Handler&& request_handler, ListenMode mode = ListenMode::SHARED)
         : ioc_(ioc)
-        // Обработчики асинхронных операций acceptor_ будут вызываться в своём strand
-        , acceptor_(net::make_strand(ioc))
+        , mode_(mode)
+        // В режиме SHARED обработчики асинхронных операций acceptor_ будут вызываться в своём strand
+        , acceptor_(MakeExecutor())
         , request_handler_(std::forward<Handler>(request_handler)) {
         // Открываем acceptor, используя протокол (IPv4 или IPv6), указанный в endpoint
         acceptor_.open(endpoint.protocol());
@@ -109,6 +180,10 @@ public:
         // Однако это может помешать повторно открыть сокет в полузакрытом состоянии.
         // Флаг reuse_address разрешает открыть сокет, когда он "наполовину закрыт"
         acceptor_.set_option(net::socket_base::reuse_address(true));
+        if (mode_ == ListenMode::PER_THREAD) {
+            // Несколько сокетов слушают один порт, входящие соединения делятся между ними
+            acceptor_.set_option(ReusePort(true));
+        }
         // Привязываем acceptor к адресу и порту endpoint
         acceptor_.bind(endpoint);
         // Переводим acceptor в состояние, в котором он способен принимать новые соединения
@@ -120,16 +195,37 @@ public:
         DoAccept();
     }
 
+    tcp::endpoint GetLocalEndpoint() const {
+        return acceptor_.local_endpoint();
+    }
+
 private:
+#ifdef SO_REUSEPORT
+    using ReusePort = net::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+#else
+    struct ReusePort {
+        explicit ReusePort(bool) {
+            throw std::runtime_error("SO_REUSEPORT is not supported");
+        }
+    };
+#endif
+
+    net::any_io_executor MakeExecutor() {
+        if (mode_ == ListenMode::PER_THREAD) {
+            return ioc_.get_executor();
+        }
+        return net::make_strand(ioc_);
+    }
+
     void AsyncRunSession(tcp::socket&& socket) {
         std::make_shared<Session<RequestHandler>>(std::move(socket), request_handler_)->Run();
     }
 
     void DoAccept() {
         acceptor_.async_accept(
-            // Передаём последовательный исполнитель, в котором будут вызываться обработчики
+            // Передаём исполнитель, в котором будут вызываться обработчики
             // асинхронных операций сокета
-            net::make_strand(ioc_),
+            MakeExecutor(),
             // С помощью bind_front_handler создаём обработчик, привязанный к методу OnAccept
             // текущего объекта.
             beast::bind_front_handler(&Listener::OnAccept, this->shared_from_this()));
@@ -149,6 +245,7 @@ private:
     }
 
     net::io_context& ioc_;
+    ListenMode mode_;
     tcp::acceptor acceptor_;
     RequestHandler request_handler_;
 };
@@ -163,4 +260,15 @@ void ServeHttp(net::io_context& ioc, const tcp::endpoint& endpoint, RequestHandl
     std::make_shared<MyListener>(ioc, endpoint, std::forward<RequestHandler>(handler))->Run();
 }
 
+// Принимает соединения в каждом из contexts своим сокетом в режиме ListenMode::PER_THREAD.
+// Каждый io_context должен выполняться ровно в одном потоке
+template <typename RequestHandler>
+void ServeHttpPerThread(const std::vector<std::unique_ptr<net::io_context>>& contexts, const tcp::endpoint& endpoint, const RequestHandler& handler) {
+    using MyListener = Listener<RequestHandler>;
+
+    for (const auto& ioc : contexts) {
+        std::make_shared<MyListener>(*ioc, endpoint, handler, ListenMode::PER_THREAD)->Run();
+    }
+}
+
 }  // namespace http_server
\ No newline at end of file
@@ -1,5 +1,8 @@
 #include "json_serializer.h"
 
+#include <charconv>
+#include <cmath>
+
 namespace json_serializer {
 
 json::value ToJson(const model::Road& road) {
@@ -75,4 +78,112 @@ json::value ToJson(const model::Dog& dog) {
     return dog_obj;
 }
 
+namespace {
+
+void AppendString(std::string& out, std::string_view str) {
+    constexpr char HEX[] = "0123456789abcdef";
+    out += '"';
+    for (char c : str) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    out += "\\u00";
+                    out += HEX[c >> 4];
+                    out += HEX[c & 0xF];
+                } else {
+                    out += c;
+                }
+        }
+    }
+    out += '"';
+}
+
+void AppendPair(std::string& out, double first, double second) {
+    out += '[';
+    AppendDouble(out, first);
+    out += ',';
+    AppendDouble(out, second);
+    out += ']';
+}
+
+void AppendPlayers(std::string& out, const std::vector<model::Dog*>& dogs) {
+    // Запись одной собаки занимает около 80 байт
+    out.reserve(out.size() + 16 + dogs.size() * 96);
+    out += "\"players\":{";
+    bool first = true;
+    for (const model::Dog* dog : dogs) {
+        if (!first) {
+            out += ',';
+        }
+        first = false;
+
+        char id[24];
+        const auto id_end = std::to_chars(id, id + sizeof(id), *dog->GetId()).ptr;
+        out += '"';
+        out.append(id, id_end);
+        out += "\":{\"pos\":";
+        AppendPair(out, dog->GetPosition().x, dog->GetPosition().y);
+        out += ",\"speed\":";
+        AppendPair(out, dog->GetSpeed().u, dog->GetSpeed().v);
+        out += ",\"dir\":";
+        AppendString(out, dog->GetDirection());
+        out += '}';
+    }
+    out += '}';
+}
+
+}  // namespace
+
+void AppendDouble(std::string& out, double value) {
+    if (std::isnan(value)) {
+        out += "NaN";
+        return;
+    }
+    if (std::isinf(value)) {
+        out += value < 0 ? "-Infinity" : "Infinity";
+        return;
+    }
+
+    // to_chars даёт те же кратчайшие цифры, что и Ryu в Boost.JSON, но в виде 1.5e+00
+    char buffer[32];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::scientific);
+    const std::string_view chars(buffer, result.ptr - buffer);
+    const size_t e_pos = chars.find('e');
+    out.append(chars.substr(0, e_pos));
+    out += 'E';
+
+    std::string_view exponent = chars.substr(e_pos + 1);
+    if (exponent.front() == '-') {
+        out += '-';
+    }
+    exponent.remove_prefix(1);
+    while (exponent.size() > 1 && exponent.front() == '0') {
+        exponent.remove_prefix(1);
+    }
+    out.append(exponent);
+}
+
+void AppendGameState(std::string& out, const std::vector<model::Dog*>& dogs) {
+    out += '{';
+    AppendPlayers(out, dogs);
+    out += '}';
+}
+
+void AppendGameStateDelta(std::string& out, uint64_t version, bool full, const std::vector<model::Dog*>& dogs) {
+    char version_chars[24];
+    const auto version_end = std::to_chars(version_chars, version_chars + sizeof(version_chars), version).ptr;
+    out += "{\"version\":";
+    out.append(version_chars, version_end);
+    out += full ? ",\"full\":true," : ",\"full\":false,";
+    AppendPlayers(out, dogs);
+    out += '}';
+}
+
 } // namespace json_serializer
\ No newline at end of file
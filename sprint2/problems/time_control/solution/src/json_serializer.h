@@ -2,6 +2,8 @@
 #include "model.h"
 #include "json_loader.h"
 #include <boost/json.hpp>
+#include <string>
+#include <vector>
 
 namespace json = boost::json;
 
@@ -13,4 +15,15 @@ json::value ToJson(const model::Road& road);
 json::value ToJson(const model::Office& office);
 json::value ToJson(const model::Dog& dog);
 
+// Дописывает в out состояние игры {"players":{...}} без построения промежуточного DOM.
+// Результат побайтно совпадает с json::serialize для объекта из ToJson
+void AppendGameState(std::string& out, const std::vector<model::Dog*>& dogs);
+
+// Дописывает в out изменения состояния {"version":...,"full":...,"players":{...}}.
+// При full == true в players перечислены все собаки сессии, иначе только изменившиеся
+void AppendGameStateDelta(std::string& out, uint64_t version, bool full, const std::vector<model::Dog*>& dogs);
+
+// Форматирует double так же, как json::serialize: 0E0, 1.5E0, 4E-1
+void AppendDouble(std::string& out, double value);
+
 } // namespace json_serializer
\ No newline at end of file
@@ -2,10 +2,15 @@
 #include <boost/asio/signal_set.hpp>
 #include <boost/system/error_code.hpp>
 #include <boost/asio/io_context.hpp>
+#include <boost/program_options.hpp>
 #include <iostream>
+#include <memory>
+#include <optional>
 #include <thread>
+#include <vector>
 #include <filesystem>
 #include <chrono> 
+#include <cstdint>
 
 #include "json_loader.h"
 #include "request_handler.h"
@@ -34,11 +39,70 @@ void RunWorkers(unsigned n, const Fn& fn) {
     fn();
 }
 
+struct Args {
+    std::optional<std::chrono::milliseconds> tick_period;
+    std::string config_file;
+    std::string www_root;
+    bool reuse_port = false;
+    bool watch_static = false;
+};
+
+[[nodiscard]] std::optional<Args> ParseCommandLine(int argc, const char* const argv[]) {
+    namespace po = boost::program_options;
+
+    po::options_description desc{"Allowed options"s};
+
+    Args args;
+    // Знаковый тип: беззнаковый молча превратил бы "-1" в огромный период
+    int64_t tick_period_ms = 0;
+    desc.add_options()
+        ("help,h", "produce help message")
+        ("tick-period,t", po::value(&tick_period_ms)->value_name("milliseconds"s), "set tick period")
+        ("config-file,c", po::value(&args.config_file)->value_name("file"s), "set config file path")
+        ("www-root,w", po::value(&args.www_root)->value_name("dir"s), "set static files root")
+        ("reuse-port", po::bool_switch(&args.reuse_port), "accept connections on every thread with its own SO_REUSEPORT socket")
+        ("watch-static", po::bool_switch(&args.watch_static), "reload cached static files when they change on disk");
+
+    // Для совместимости с прежним запуском пути можно передать позиционными аргументами
+    po::positional_options_description positional;
+    positional.add("config-file", 1).add("www-root", 1);
+
+    po::variables_map vm;
+    po::store(po::command_line_parser(argc, argv).options(desc).positional(positional).run(), vm);
+    po::notify(vm);
+
+    if (vm.contains("help"s)) {
+        std::cout << desc;
+        return std::nullopt;
+    }
+    if (!vm.contains("config-file"s)) {
+        throw std::runtime_error("Config file path is not specified"s);
+    }
+    if (!vm.contains("www-root"s)) {
+        throw std::runtime_error("Static files root is not specified"s);
+    }
+    if (vm.contains("tick-period"s)) {
+        if (tick_period_ms <= 0) {
+            throw std::runtime_error("Tick period must be positive"s);
+        }
+        args.tick_period = std::chrono::milliseconds{tick_period_ms};
+    }
+    return args;
+}
+
 }  // namespace
 
 int main(int argc, const char* argv[]) {
-    if (argc != 3) {
-        std::cerr << "Usage: game_server <game-config-json> <static-root>"sv << std::endl;
+    Args args;
+    try {
+        auto parsed = ParseCommandLine(argc, argv);
+        if (!parsed) {
+            return EXIT_SUCCESS;
+        }
+        args = std::move(*parsed);
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        std::cerr << "Usage: game_server [--tick-period <ms>] [--reuse-port] [--watch-static] --config-file <game-config-json> --www-root <static-root>"sv << std::endl;
         return EXIT_FAILURE;
     }
 
@@ -46,17 +110,26 @@ int main(int argc, const char* argv[]) {
 
     try {
         // 1. Загружаем карту из файла и построить модель игры
-        model::Game game = json_loader::LoadGame(argv[1]);
+        model::Game game = json_loader::LoadGame(args.config_file);
         
         // 2. Инициализируем io_context
-        const unsigned num_threads = std::thread::hardware_concurrency();
-        net::io_context ioc(num_threads);
+        const unsigned num_threads = std::max(1u, std::thread::hardware_concurrency());
+        // Обычно все потоки выполняют один io_context. С --reuse-port у каждого потока свой
+        // io_context: он принимает соединения своим сокетом и выполняет часть игровых сессий
+        std::vector<std::unique_ptr<net::io_context>> contexts;
+        for (unsigned i = 0; i < (args.reuse_port ? num_threads : 1); ++i) {
+            contexts.push_back(std::make_unique<net::io_context>(args.reuse_port ? 1 : num_threads));
+        }
+        net::io_context& ioc = *contexts.front();
 
         app::Players players; 
-        app::Application app{game, players, ioc};
+        app::Application app{game, players, contexts};
+        if (args.tick_period) {
+            app.StartAutoTick(*args.tick_period);
+        }
         
         // Каталог со статическими файлами
-        std::filesystem::path static_root{argv[2]};
+        std::filesystem::path static_root{args.www_root};
         if (!std::filesystem::is_directory(static_root)) {
             std::cerr << "Static root is not a directory or doesn't exist" << std::endl;
             return EXIT_FAILURE;
@@ -64,14 +137,20 @@ int main(int argc, const char* argv[]) {
 
         // 3. Добавляем асинхронный обработчик сигналов SIGINT и SIGTERM
         net::signal_set signals(ioc, SIGINT, SIGTERM);
-        signals.async_wait([&ioc](const sys::error_code& ec, [[maybe_unused]] int signal_number) {
+        signals.async_wait([&contexts](const sys::error_code& ec, [[maybe_unused]] int signal_number) {
             if (!ec) {
-                ioc.stop();
+                for (auto& context : contexts) {
+                    context->stop();
+                }
             }
         });
 
         // 4. Создаём обработчик HTTP-запросов и связываем его с моделью игры
+        // Статические файлы читаются в память при запуске
         http_handler::RequestHandler handler{app, static_root};
+        if (args.watch_static) {
+            handler.WatchStaticFiles(ioc);
+        }
 
         // 5. Запустить обработчик HTTP-запросов, делегируя их обработчику запросов
         const auto address = net::ip::make_address("0.0.0.0");
@@ -94,13 +173,18 @@ int main(int argc, const char* argv[]) {
                 auto resp_time_ms = duration_cast<milliseconds>(end_time - start_time);
 
                 json::value content_type = nullptr;
-                if(response.find(http::field::content_type) != response.end()) {
-                    content_type = std::string(response.at(http::field::content_type));
+                unsigned code = static_cast<unsigned>(http::status::switching_protocols);
+                // Переход на WebSocket отвечает 101 Switching Protocols
+                if constexpr (!std::is_same_v<std::decay_t<decltype(response)>, http_server::WebSocketAccept>) {
+                    if(response.find(http::field::content_type) != response.end()) {
+                        content_type = std::string(response.at(http::field::content_type));
+                    }
+                    code = response.result_int();
                 }
 
                 json::value resp_data{
                     {"response_time", resp_time_ms.count()},
-                    {"code", response.result_int()},
+                    {"code", code},
                     {"content_type", content_type}
                 };
                 BOOST_LOG_TRIVIAL(info) << logging::add_value(additional_data, resp_data)
@@ -112,17 +196,30 @@ int main(int argc, const char* argv[]) {
             handler(std::forward<decltype(req)>(req), logging_send);
         };
         
-        http_server::ServeHttp(ioc, {address, port}, logging_handler);
+        if (args.reuse_port) {
+            http_server::ServeHttpPerThread(contexts, {address, port}, logging_handler);
+        } else {
+            http_server::ServeHttp(ioc, {address, port}, logging_handler);
+        }
 
         // Сообщение о запуске сервера
         json::value start_data{{"port", port}, {"address", address.to_string()}};
         BOOST_LOG_TRIVIAL(info) << logging::add_value(additional_data, start_data)
                                 << "server started"sv;
 
-        // 6. Запускаем обработку асинхронных операций
-        RunWorkers(std::max(1u, num_threads), [&ioc] {
-            ioc.run();
-        });
+        // 6. Запускаем обработку асинхронных операций. Всего работает num_threads потоков:
+        // по одному на каждый io_context с --reuse-port, иначе все на общем ioc
+        {
+            std::vector<std::jthread> context_workers;
+            for (size_t i = 1; i < contexts.size(); ++i) {
+                context_workers.emplace_back([&context = *contexts[i]] {
+                    context.run();
+                });
+            }
+            RunWorkers(args.reuse_port ? 1 : num_threads, [&ioc] {
+                ioc.run();
+            });
+        }
 
         json::value exit_data{{"code", 0}};
         BOOST_LOG_TRIVIAL(info) << logging::add_value(additional_data, exit_data)
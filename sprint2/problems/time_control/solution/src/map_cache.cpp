@@ -0,0 +1,33 @@
+#include "map_cache.h"
+#include "http_cache.h"
+#include "json_serializer.h"
+
+namespace http_handler {
+
+namespace {
+
+MapCache::Entry MakeEntry(const json::value& value) {
+    auto body = std::make_shared<const std::string>(json::serialize(value));
+    std::string etag = MakeStrongETag(*body);
+    return {std::move(body), std::move(etag)};
+}
+
+}  // namespace
+
+MapCache::MapCache(const std::vector<model::Map>& maps) {
+    json::array maps_array;
+    for (const auto& map : maps) {
+        maps_array.push_back(json_serializer::ToJson(map, true));
+        maps_.emplace(*map.GetId(), MakeEntry(json_serializer::ToJson(map, false)));
+    }
+    map_list_ = MakeEntry(maps_array);
+}
+
+const MapCache::Entry* MapCache::FindMap(std::string_view id) const {
+    if (auto it = maps_.find(id); it != maps_.end()) {
+        return &it->second;
+    }
+    return nullptr;
+}
+
+}  // namespace http_handler
@@ -0,0 +1,41 @@
+#pragma once
+#include "model.h"
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace http_handler {
+
+// Карты не меняются после загрузки, поэтому их JSON сериализуется один раз при запуске
+// и затем отдаётся всем клиентам из общих неизменяемых буферов
+class MapCache {
+public:
+    struct Entry {
+        std::shared_ptr<const std::string> body;
+        std::string etag;
+    };
+
+    explicit MapCache(const std::vector<model::Map>& maps);
+
+    const Entry& GetMapList() const noexcept {
+        return map_list_;
+    }
+
+    const Entry* FindMap(std::string_view id) const;
+
+private:
+    struct StringHasher {
+        using is_transparent = void;
+        size_t operator()(std::string_view s) const noexcept {
+            return std::hash<std::string_view>{}(s);
+        }
+    };
+
+    Entry map_list_;
+    // Поиск по string_view без создания строки
+    std::unordered_map<std::string, Entry, StringHasher, std::equal_to<>> maps_;
+};
+
+}  // namespace http_handler
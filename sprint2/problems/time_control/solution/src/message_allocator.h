@@ -0,0 +1,139 @@
+#pragma once
+#include <boost/beast/http/fields.hpp>
+#include <boost/beast/http/string_body.hpp>
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <string>
+
+namespace http_server {
+
+namespace detail {
+
+// Освобождённые блоки памяти потока, разложенные по классам размеров.
+// Запрос читается в executor соединения, а освобождается в strand игровой сессии,
+// с ответом наоборот, поэтому блок возвращается в кэш того потока, который его освободил.
+// Потоки обслуживают и соединения, и сессии, так что блоки между ними не перетекают надолго
+class BlockCache {
+public:
+    static constexpr std::size_t GRANULARITY = 64;
+    // Блоки больше GRANULARITY * CLASS_COUNT байт не кэшируются
+    static constexpr std::size_t CLASS_COUNT = 16;
+    // Сверх этого числа освобождённые блоки класса возвращаются в кучу
+    static constexpr std::size_t MAX_FREE_BLOCKS = 256;
+
+    void* Allocate(std::size_t size) {
+        const std::size_t index = GetClassIndex(size);
+        if (index >= CLASS_COUNT) {
+            return ::operator new(size);
+        }
+        FreeList& list = lists_[index];
+        if (list.head == nullptr) {
+            return ::operator new((index + 1) * GRANULARITY);
+        }
+        FreeBlock* block = list.head;
+        list.head = block->next;
+        --list.count;
+        return block;
+    }
+
+    void Deallocate(void* p, std::size_t size) noexcept {
+        const std::size_t index = GetClassIndex(size);
+        if (index >= CLASS_COUNT || disabled_ || lists_[index].count >= MAX_FREE_BLOCKS) {
+            return ::operator delete(p);
+        }
+        FreeList& list = lists_[index];
+        list.head = ::new (p) FreeBlock{list.head};
+        ++list.count;
+    }
+
+    // Возвращает блоки в кучу. Вызывается при завершении потока, после чего кэш не используется
+    void Release() noexcept {
+        disabled_ = true;
+        for (FreeList& list : lists_) {
+            while (list.head != nullptr) {
+                FreeBlock* block = list.head;
+                list.head = block->next;
+                ::operator delete(block);
+            }
+            list.count = 0;
+        }
+    }
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+    struct FreeList {
+        FreeBlock* head = nullptr;
+        std::size_t count = 0;
+    };
+
+    static constexpr std::size_t GetClassIndex(std::size_t size) noexcept {
+        // Для size == 0 получается заведомо большой индекс, и блок берётся из кучи
+        return (size - 1) / GRANULARITY;
+    }
+
+    std::array<FreeList, CLASS_COUNT> lists_{};
+    bool disabled_ = false;
+};
+
+// Кэш не имеет деструктора и доступен до самого конца потока.
+// Блоки освобождает отдельный объект, создаваемый при первом обращении
+inline BlockCache& GetBlockCache() noexcept {
+    struct Releaser {
+        ~Releaser() {
+            GetBlockCache().Release();
+        }
+    };
+    thread_local BlockCache cache;
+    thread_local Releaser releaser;
+    (void)releaser;
+    return cache;
+}
+
+}  // namespace detail
+
+// Аллокатор без состояния для заголовков и тел HTTP-сообщений. Освобождённые блоки
+// остаются в кэше потока и переиспользуются следующими сообщениями без блокировок.
+// К куче аллокатор обращается, когда в кэше нет блока нужного размера.
+// Создаётся по умолчанию, поэтому сообщения с такими полями конструируются так же, как обычные
+template <typename T>
+class MessageAllocator {
+public:
+    using value_type = T;
+
+    MessageAllocator() noexcept = default;
+    template <typename U>
+    MessageAllocator(const MessageAllocator<U>&) noexcept {
+    }
+
+    T* allocate(std::size_t n) {
+        if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+            return std::allocator<T>{}.allocate(n);
+        } else {
+            return static_cast<T*>(detail::GetBlockCache().Allocate(n * sizeof(T)));
+        }
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+            std::allocator<T>{}.deallocate(p, n);
+        } else {
+            detail::GetBlockCache().Deallocate(p, n * sizeof(T));
+        }
+    }
+
+    template <typename U>
+    bool operator==(const MessageAllocator<U>&) const noexcept {
+        return true;
+    }
+};
+
+using ResponseFields = boost::beast::http::basic_fields<MessageAllocator<char>>;
+using RequestFields = boost::beast::http::basic_fields<MessageAllocator<char>>;
+// Тело запроса в той же памяти, что и заголовки
+using RequestBody = boost::beast::http::basic_string_body<char, std::char_traits<char>, MessageAllocator<char>>;
+
+}  // namespace http_server
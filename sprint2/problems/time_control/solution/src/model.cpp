@@ -5,10 +5,61 @@
 #include <chrono>
 #include <algorithm>
 #include <cmath>
+#include <functional>
+#include <mutex>
 
 namespace model {
 using namespace std::literals;
 
+void RoadBorders::Add(const Road& road) {
+    const auto start = road.GetStart();
+    const auto end = road.GetEnd();
+    x_min.push_back(std::min(start.x, end.x) - Road::HALF_WIDTH);
+    x_max.push_back(std::max(start.x, end.x) + Road::HALF_WIDTH);
+    y_min.push_back(std::min(start.y, end.y) - Road::HALF_WIDTH);
+    y_max.push_back(std::max(start.y, end.y) + Road::HALF_WIDTH);
+}
+
+Coord RoadGrid::ToCell(Coord coord) noexcept {
+    // Деление с округлением вниз, чтобы отрицательные координаты попадали в свои ячейки
+    return coord >= 0 ? coord / CELL_SIZE : (coord - CELL_SIZE + 1) / CELL_SIZE;
+}
+
+RoadGrid::CellKey RoadGrid::MakeKey(Coord cell_x, Coord cell_y) noexcept {
+    return (static_cast<CellKey>(static_cast<uint32_t>(cell_x)) << 32) | static_cast<uint32_t>(cell_y);
+}
+
+void RoadGrid::AddRoad(size_t index, const Road& road) {
+    const auto start = road.GetStart();
+    const auto end = road.GetEnd();
+    const Coord cell_x_min = ToCell(std::min(start.x, end.x));
+    const Coord cell_x_max = ToCell(std::max(start.x, end.x));
+    const Coord cell_y_min = ToCell(std::min(start.y, end.y));
+    const Coord cell_y_max = ToCell(std::max(start.y, end.y));
+
+    for (Coord cell_x = cell_x_min; cell_x <= cell_x_max; ++cell_x) {
+        for (Coord cell_y = cell_y_min; cell_y <= cell_y_max; ++cell_y) {
+            cells_[MakeKey(cell_x, cell_y)].push_back(index);
+        }
+    }
+}
+
+const RoadGrid::RoadIndices& RoadGrid::FindRoads(PointD pos) const {
+    const Coord x = static_cast<Coord>(std::lround(pos.x));
+    const Coord y = static_cast<Coord>(std::lround(pos.y));
+    if (auto it = cells_.find(MakeKey(ToCell(x), ToCell(y))); it != cells_.end()) {
+        return it->second;
+    }
+    return empty_;
+}
+
+void Map::AddRoad(const Road& road) {
+    const size_t index = roads_.size();
+    roads_.emplace_back(road);
+    road_borders_.Add(road);
+    road_grid_.AddRoad(index, road);
+}
+
 void Map::AddOffice(Office office) {
     if (warehouse_id_to_index_.contains(office.GetId())) {
         throw std::invalid_argument("Duplicate warehouse");
@@ -43,95 +94,109 @@ void GameSession::AddDog(Dog* dog) {
     dog->SetDirection("U");
 
     dogs_.push_back(dog);
+    ++version_;
+    RecordChange(dog);
+    TrimJournal();
 }
 
-namespace {
+void GameSession::SetDogMovement(Dog* dog, Vec2D speed, std::string direction) {
+    dog->SetSpeed(speed);
+    dog->SetDirection(std::move(direction));
+    ++version_;
+    RecordChange(dog);
+    TrimJournal();
+}
 
-std::pair<PointD, PointD> GetRoadBorders(const Road& road) {
-    constexpr double ROAD_HALF_WIDTH = 0.4;
-    auto start = road.GetStart();
-    auto end = road.GetEnd();
+std::optional<std::vector<Dog*>> GameSession::GetDogsChangedSince(uint64_t since) const {
+    if (since < journal_begin_ || since > version_) {
+        return std::nullopt;
+    }
 
-    double x_min = std::min(static_cast<double>(start.x), static_cast<double>(end.x));
-    double x_max = std::max(static_cast<double>(start.x), static_cast<double>(end.x));
-    double y_min = std::min(static_cast<double>(start.y), static_cast<double>(end.y));
-    double y_max = std::max(static_cast<double>(start.y), static_cast<double>(end.y));
-    
-    return {
-        {x_min - ROAD_HALF_WIDTH, y_min - ROAD_HALF_WIDTH},
-        {x_max + ROAD_HALF_WIDTH, y_max + ROAD_HALF_WIDTH}
-    };
+    const auto first = std::upper_bound(journal_.begin(), journal_.end(), since,
+        [](uint64_t version, const JournalRecord& record) {
+            return version < record.version;
+        });
+    std::vector<Dog*> dogs;
+    dogs.reserve(journal_.end() - first);
+    for (auto it = first; it != journal_.end(); ++it) {
+        dogs.push_back(it->dog);
+    }
+    // Повторные записи одной собаки после сортировки по id оказываются рядом.
+    // Адрес различает собак с одинаковым id, которые ещё не получили свой
+    std::sort(dogs.begin(), dogs.end(), [](const Dog* lhs, const Dog* rhs) {
+        if (lhs->GetId() != rhs->GetId()) {
+            return *lhs->GetId() < *rhs->GetId();
+        }
+        return std::less<const Dog*>{}(lhs, rhs);
+    });
+    dogs.erase(std::unique(dogs.begin(), dogs.end()), dogs.end());
+    return dogs;
 }
 
-
-bool IsOnRoad(const PointD& pos, const std::pair<PointD, PointD>& borders) {
-    return pos.x >= borders.first.x && pos.x <= borders.second.x &&
-           pos.y >= borders.first.y && pos.y <= borders.second.y;
+void GameSession::RecordChange(Dog* dog) {
+    journal_.push_back({version_, dog});
 }
 
+void GameSession::TrimJournal() {
+    while (journal_.size() > JOURNAL_CAPACITY) {
+        // Версия отброшенной записи могла потерять и другие свои записи
+        journal_begin_ = journal_.front().version;
+        journal_.pop_front();
+    }
 }
 
-void GameSession::Tick(std::chrono::milliseconds delta) {
-    const double delta_s = static_cast<double>(delta.count()) / 1000.0;
+void GameSession::MoveDog(Dog& dog, double delta_s) const {
+    const auto start_pos = dog.GetPosition();
+    const auto speed = dog.GetSpeed();
+    const PointD end_pos_estimated{start_pos.x + speed.u * delta_s, start_pos.y + speed.v * delta_s};
+    const auto& borders = map_->GetRoadBorders();
 
-    for (auto& dog : dogs_) {
-        if (dog->GetSpeed().u == 0.0 && dog->GetSpeed().v == 0.0) {
+    // Из нескольких дорог под собакой выбираем ту, по которой она уйдёт дальше всего
+    std::optional<PointD> final_pos;
+    double max_dist_sq = -1.0;
+    for (size_t road : map_->GetRoadGrid().FindRoads(start_pos)) {
+        if (!borders.Contains(road, start_pos)) {
             continue;
         }
+        const PointD bounded_pos = borders.Clamp(road, end_pos_estimated);
+        const double dist_sq = std::pow(bounded_pos.x - start_pos.x, 2) + std::pow(bounded_pos.y - start_pos.y, 2);
+        if (dist_sq > max_dist_sq) {
+            max_dist_sq = dist_sq;
+            final_pos = bounded_pos;
+        }
+    }
 
-        const auto start_pos = dog->GetPosition();
-        const auto speed = dog->GetSpeed();
-        PointD end_pos_estimated{start_pos.x + speed.u * delta_s, start_pos.y + speed.v * delta_s};
+    if (!final_pos) {
+        // Собака оказалась вне дорог и останавливается на месте
+        dog.SetSpeed({0.0, 0.0});
+        return;
+    }
+    dog.SetPosition(*final_pos);
 
-        std::vector<const Road*> current_roads;
-        for (const auto& road : map_->GetRoads()) {
-            if (IsOnRoad(start_pos, GetRoadBorders(road))) {
-                current_roads.push_back(&road);
-            }
-        }
-        
-        if (current_roads.empty()) {
-            dog->SetSpeed({0.0, 0.0});
-            continue;
-        }
+    auto is_close = [](double a, double b) {
+        return std::abs(a - b) < 1e-9;
+    };
+    if (!is_close(final_pos->x, end_pos_estimated.x) || !is_close(final_pos->y, end_pos_estimated.y)) {
+        dog.SetSpeed({0.0, 0.0});
+    }
+}
 
-        PointD final_pos;
-        if (current_roads.size() == 1) {
-            auto borders = GetRoadBorders(*current_roads.front());
-            final_pos.x = std::clamp(end_pos_estimated.x, borders.first.x, borders.second.x);
-            final_pos.y = std::clamp(end_pos_estimated.y, borders.first.y, borders.second.y);
-        } else {
-            final_pos = start_pos;
-            double max_dist_sq = -1.0;
-
-            for (const auto* road : current_roads) {
-                auto borders = GetRoadBorders(*road);
-                PointD bounded_pos;
-                bounded_pos.x = std::clamp(end_pos_estimated.x, borders.first.x, borders.second.x);
-                bounded_pos.y = std::clamp(end_pos_estimated.y, borders.first.y, borders.second.y);
-
-                double dist_sq = std::pow(bounded_pos.x - start_pos.x, 2) + std::pow(bounded_pos.y - start_pos.y, 2);
-
-                if (dist_sq > max_dist_sq) {
-                    max_dist_sq = dist_sq;
-                    final_pos = bounded_pos;
-                }
-            }
+void GameSession::Tick(std::chrono::milliseconds delta) {
+    const double delta_s = static_cast<double>(delta.count()) / 1000.0;
+
+    ++version_;
+    for (Dog* dog : dogs_) {
+        // Стоящих собак тик не меняет, и в журнал они не попадают
+        if (dog->GetSpeed().u == 0.0 && dog->GetSpeed().v == 0.0) {
+            continue;
         }
-        
-        dog->SetPosition(final_pos);
-        
-        auto is_close = [](double a, double b) {
-            return std::abs(a - b) < 1e-9;
-        };
-        auto points_are_close = [&](const PointD& p1, const PointD& p2) {
-            return is_close(p1.x, p2.x) && is_close(p1.y, p2.y);
-        };
-
-        if (!points_are_close(final_pos, end_pos_estimated)) {
-            dog->SetSpeed({0.0, 0.0});
+        MoveDog(*dog, delta_s);
+        // Движущуюся собаку тик сдвигает или останавливает. При нулевом delta сдвига нет
+        if (delta_s != 0.0 || (dog->GetSpeed().u == 0.0 && dog->GetSpeed().v == 0.0)) {
+            RecordChange(dog);
         }
     }
+    TrimJournal();
 }
 
 
@@ -157,6 +222,7 @@ const Map* Game::FindMap(const Map::Id& id) const noexcept {
 }
 
 GameSession* Game::FindSession(const Map::Id& id) {
+    std::shared_lock lock{*sessions_mutex_};
     if (auto it = session_id_to_index_.find(id); it != session_id_to_index_.end()) {
         return &sessions_.at(it->second);
     }
@@ -168,16 +234,29 @@ GameSession* Game::AddSession(const Map::Id& id) {
     if (!map) {
         return nullptr;
     }
+    std::unique_lock lock{*sessions_mutex_};
+    if (auto it = session_id_to_index_.find(id); it != session_id_to_index_.end()) {
+        return &sessions_.at(it->second);
+    }
     const size_t index = sessions_.size();
     auto& session = sessions_.emplace_back(map);
-    session_id_to_index_[id] = index;
+    try {
+        session_id_to_index_.emplace(id, index);
+    } catch (...) {
+        sessions_.pop_back();
+        throw;
+    }
     return &session;
 }
 
-void Game::Tick(std::chrono::milliseconds delta) {
+std::vector<GameSession*> Game::GetSessions() {
+    std::shared_lock lock{*sessions_mutex_};
+    std::vector<GameSession*> sessions;
+    sessions.reserve(sessions_.size());
     for (auto& session : sessions_) {
-        session.Tick(delta);
+        sessions.push_back(&session);
     }
+    return sessions;
 }
 
 }  // namespace model
\ No newline at end of file
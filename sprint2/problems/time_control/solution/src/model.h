@@ -2,10 +2,13 @@
 #include <string>
 #include <unordered_map>
 #include <vector>
+#include <deque>
+#include <shared_mutex>
 #include <optional>
 #include <memory>
 #include <random>
 #include <chrono>
+#include <algorithm>
 
 #include "tagged.h"
 
@@ -80,6 +83,7 @@ class Road {
 public:
     constexpr static HorizontalTag HORIZONTAL{};
     constexpr static VerticalTag VERTICAL{};
+    constexpr static double HALF_WIDTH = 0.4;
 
     Road(HorizontalTag, Point start, Coord end_x) noexcept
         : start_{start}
@@ -112,6 +116,58 @@ private:
     Point end_;
 };
 
+// Прямоугольники дорог с учётом их ширины. Хранятся по столбцам в непрерывных
+// массивах, чтобы проверку точки по многим дорогам можно было векторизовать
+struct RoadBorders {
+    std::vector<double> x_min;
+    std::vector<double> x_max;
+    std::vector<double> y_min;
+    std::vector<double> y_max;
+
+    size_t Size() const noexcept {
+        return x_min.size();
+    }
+
+    void Add(const Road& road);
+
+    bool Contains(size_t index, PointD pos) const noexcept {
+        return pos.x >= x_min[index] && pos.x <= x_max[index] &&
+               pos.y >= y_min[index] && pos.y <= y_max[index];
+    }
+
+    PointD Clamp(size_t index, PointD pos) const noexcept {
+        return {std::clamp(pos.x, x_min[index], x_max[index]),
+                std::clamp(pos.y, y_min[index], y_max[index])};
+    }
+};
+
+// Равномерная сетка для быстрого поиска дорог, на которых может находиться точка.
+// Каждая дорога регистрируется во всех ячейках, через которые проходит её ось.
+// Полуширина дороги меньше 0.5, поэтому любая дорога, содержащая точку, проходит
+// через ближайшую к ней целочисленную точку, и достаточно просмотреть одну ячейку.
+class RoadGrid {
+public:
+    using RoadIndices = std::vector<size_t>;
+
+    // Размер ячейки сетки в единицах карты
+    constexpr static Dimension CELL_SIZE = 8;
+
+    void AddRoad(size_t index, const Road& road);
+
+    // Возвращает индексы дорог-кандидатов в порядке их добавления на карту.
+    // Принадлежность точки дороге вызывающая сторона проверяет сама
+    const RoadIndices& FindRoads(PointD pos) const;
+
+private:
+    using CellKey = uint64_t;
+
+    static Coord ToCell(Coord coord) noexcept;
+    static CellKey MakeKey(Coord cell_x, Coord cell_y) noexcept;
+
+    std::unordered_map<CellKey, RoadIndices> cells_;
+    RoadIndices empty_;
+};
+
 class Building {
 public:
     explicit Building(Rectangle bounds) noexcept
@@ -194,10 +250,16 @@ public:
         dog_speed_ = speed;
     }
 
-    void AddRoad(const Road& road) {
-        roads_.emplace_back(road);
+    const RoadBorders& GetRoadBorders() const noexcept {
+        return road_borders_;
     }
 
+    const RoadGrid& GetRoadGrid() const noexcept {
+        return road_grid_;
+    }
+
+    void AddRoad(const Road& road);
+
     void AddBuilding(const Building& building) {
         buildings_.emplace_back(building);
     }
@@ -210,6 +272,8 @@ private:
     Id id_;
     std::string name_;
     Roads roads_;
+    RoadBorders road_borders_;
+    RoadGrid road_grid_;
     Buildings buildings_;
     std::optional<double> dog_speed_;
 
@@ -225,12 +289,40 @@ public:
     const std::vector<Dog*>& GetDogs() const { return dogs_; }
 
     void AddDog(Dog* dog);
+    // Задаёт собаке скорость и направление движения
+    void SetDogMovement(Dog* dog, Vec2D speed, std::string direction);
     void Tick(std::chrono::milliseconds delta);
 
+    // Версия состояния собак сессии. Увеличивается при каждом его изменении,
+    // поэтому по ней можно кешировать производные от состояния данные
+    uint64_t GetVersion() const noexcept { return version_; }
+    // Собаки, у которых позиция, скорость или направление менялись после версии since,
+    // по возрастанию id. Если журнал изменений уже не покрывает since,
+    // возвращает std::nullopt, и клиенту нужно полное состояние
+    std::optional<std::vector<Dog*>> GetDogsChangedSince(uint64_t since) const;
+
+    // Наибольшее число записей в журнале изменений. Старые записи отбрасываются
+    static constexpr size_t JOURNAL_CAPACITY = 1 << 16;
+
 private:
+    struct JournalRecord {
+        uint64_t version;
+        Dog* dog;
+    };
+
+    // Перемещает движущуюся собаку по дорогам. Собака, упёршаяся в границу дороги
+    // или оказавшаяся вне дорог, останавливается
+    void MoveDog(Dog& dog, double delta_s) const;
+    void RecordChange(Dog* dog);
+    void TrimJournal();
+
     const Map* map_;
     std::vector<Dog*> dogs_;
     std::mt19937_64 generator_{std::random_device{}()};
+    uint64_t version_ = 0;
+    // Записи упорядочены по версии. Журнал полон для всех версий после journal_begin_
+    std::deque<JournalRecord> journal_;
+    uint64_t journal_begin_ = 0;
 };
 
 class Game {
@@ -253,10 +345,14 @@ public:
 
     const Map* FindMap(const Map::Id& id) const noexcept;
     GameSession* FindSession(const Map::Id& id);
+    // Возвращает сессию карты, создавая её при первом обращении.
+    // Адрес сессии не меняется до разрушения игры
     GameSession* AddSession(const Map::Id& id);
-    void Tick(std::chrono::milliseconds delta);
+    // Снимок списка сессий. Можно вызывать одновременно с AddSession
+    std::vector<GameSession*> GetSessions();
 
 private:
+
     using MapIdHasher = util::TaggedHasher<Map::Id>;
     using MapIdToIndex = std::unordered_map<Map::Id, size_t, MapIdHasher>;
     using SessionIdToIndex = std::unordered_map<Map::Id, size_t, MapIdHasher>;
@@ -265,8 +361,12 @@ private:
     std::vector<Map> maps_;
     MapIdToIndex map_id_to_index_;
     
-    std::vector<GameSession> sessions_;
+    // deque не перемещает элементы при добавлении, поэтому указатели на сессии,
+    // сохранённые игроками, остаются действительными
+    std::deque<GameSession> sessions_;
     SessionIdToIndex session_id_to_index_;
+    // Защищает sessions_ и session_id_to_index_. Хранится в куче, чтобы Game оставался перемещаемым
+    std::unique_ptr<std::shared_mutex> sessions_mutex_ = std::make_unique<std::shared_mutex>();
 };
 
 }  // namespace model
\ No newline at end of file
@@ -4,12 +4,13 @@ namespace http_handler {
 
 RequestHandler::RequestHandler(app::Application& app, fs::path static_root)
     : api_handler_{app}
-    , static_root_{std::move(static_root)} {
+    , static_root_{std::move(static_root)}
+    , static_cache_{static_root_} {
 }
 
 StringResponse RequestHandler::MakeStringResponse(http::status status, std::string_view body, unsigned version, bool keep_alive, http::verb method, std::string_view content_type) {
     StringResponse res{status, version};
-    res.set(http::field::content_type, std::string(content_type));
+    res.set(http::field::content_type, ToHeaderValue(content_type));
     res.set(http::field::cache_control, "no-cache");
     res.keep_alive(keep_alive);
     
@@ -24,4 +25,68 @@ StringResponse RequestHandler::MakeStringResponse(http::status status, std::stri
     return res;
 }
 
-}  // namespace http_handler
\ No newline at end of file
+void RequestHandler::SetCachedFileHeaders(http::response_header<http_server::ResponseFields>& header, const StaticFileCache::Entry& entry, const StaticFileCache::Variant* variant) {
+    header.set(http::field::content_type, ToHeaderValue(entry.content_type));
+    header.set(http::field::cache_control, "no-cache");
+    header.set(http::field::etag, variant ? variant->etag : entry.etag);
+    header.set(http::field::last_modified, entry.last_modified_text);
+    header.set(http::field::accept_ranges, "bytes");
+    if (variant) {
+        header.set(http::field::content_encoding, ToHeaderValue(variant->encoding));
+    }
+    if (!entry.variants.empty()) {
+        // Ответ на тот же путь зависит от Accept-Encoding
+        header.set(http::field::vary, "Accept-Encoding");
+    }
+}
+
+SharedStringResponse RequestHandler::MakeCachedFileResponse(const StaticFileCache::Entry& entry, const StaticFileCache::Variant* variant, unsigned version, bool keep_alive, http::verb method) {
+    const auto& body = variant ? variant->body : entry.body;
+    SharedStringResponse res{http::status::ok, version};
+    SetCachedFileHeaders(res, entry, variant);
+    res.content_length(body->size());
+    res.keep_alive(keep_alive);
+
+    if (method != http::verb::head) {
+        res.body() = body;
+    }
+
+    return res;
+}
+
+ByteRangesResponse RequestHandler::MakeCachedRangesResponse(const StaticFileCache::Entry& entry, std::vector<ByteRange> ranges, unsigned version, bool keep_alive) {
+    ByteRangesResponse res{http::status::partial_content, version};
+    SetCachedFileHeaders(res, entry, nullptr);
+    if (ranges.size() == 1) {
+        res.set(http::field::content_range, MakeContentRange(ranges.front(), entry.size));
+        res.body() = {entry.body, std::move(ranges), {}};
+    } else {
+        // Граница берётся из ETag: она постоянна для файла и вряд ли встретится в его содержимом
+        const std::string boundary = "byteranges-" + entry.etag.substr(1, entry.etag.size() - 2);
+        res.set(http::field::content_type, "multipart/byteranges; boundary=" + boundary);
+        res.body() = MakeMultipartRanges(entry.body, std::move(ranges), entry.content_type, boundary);
+    }
+    res.keep_alive(keep_alive);
+    res.prepare_payload();
+    return res;
+}
+
+EmptyResponse RequestHandler::MakeNotModifiedFileResponse(const StaticFileCache::Entry& entry, std::string_view etag, unsigned version, bool keep_alive) {
+    // Ответ 304 повторяет только валидаторы и заголовки кэширования (RFC 9110, 15.4.5)
+    EmptyResponse res{http::status::not_modified, version};
+    res.set(http::field::cache_control, "no-cache");
+    res.set(http::field::etag, ToHeaderValue(etag));
+    if (!entry.variants.empty()) {
+        res.set(http::field::vary, "Accept-Encoding");
+    }
+    res.keep_alive(keep_alive);
+    return res;
+}
+
+StringResponse RequestHandler::MakeRangeNotSatisfiableResponse(uint64_t size, unsigned version, bool keep_alive, http::verb method) {
+    auto res = MakeStringResponse(http::status::range_not_satisfiable, "Range Not Satisfiable", version, keep_alive, method);
+    res.set(http::field::content_range, "bytes */" + std::to_string(size));
+    return res;
+}
+
+}  // namespace http_handler
@@ -2,10 +2,14 @@
 #include "http_server.h"
 #include "api_handler.h"
 #include "application.h"
+#include "http_cache.h"
+#include "http_range.h"
+#include "static_file_cache.h"
 #include <string_view>
 #include <string>
 #include <filesystem>
 #include <algorithm>
+#include <optional>
 
 namespace http_handler {
 
@@ -14,13 +18,28 @@ namespace http = beast::http;
 namespace fs = std::filesystem;
 using namespace std::literals;
 
-using StringResponse = http::response<http::string_body>;
-using FileResponse = http::response<http::file_body>;
+using StringResponse = http::response<http::string_body, http_server::ResponseFields>;
+using FileResponse = http::response<http_server::SendfileBody, http_server::ResponseFields>;
+
+// Значение заголовка или nullopt, если его нет
+template <typename Fields>
+std::optional<std::string_view> FindField(const Fields& fields, http::field name) {
+    auto it = fields.find(name);
+    if (it == fields.end()) {
+        return std::nullopt;
+    }
+    return std::string_view{it->value().data(), it->value().size()};
+}
 
 class RequestHandler {
 public:
     explicit RequestHandler(app::Application& app, fs::path static_root);
 
+    // Включает обновление кэша статических файлов при их изменении на диске
+    void WatchStaticFiles(net::io_context& ioc) {
+        static_cache_.Watch(ioc);
+    }
+
     RequestHandler(const RequestHandler&) = delete;
     RequestHandler& operator=(const RequestHandler&) = delete;
 
@@ -46,12 +65,21 @@ public:
 
 private:
     StringResponse MakeStringResponse(http::status status, std::string_view body, unsigned version, bool keep_alive, http::verb method, std::string_view content_type = "text/plain"sv);
+    // variant - сжатый вариант файла или nullptr
+    SharedStringResponse MakeCachedFileResponse(const StaticFileCache::Entry& entry, const StaticFileCache::Variant* variant, unsigned version, bool keep_alive, http::verb method);
+    // 206 с одним диапазоном или multipart/byteranges с несколькими
+    ByteRangesResponse MakeCachedRangesResponse(const StaticFileCache::Entry& entry, std::vector<ByteRange> ranges, unsigned version, bool keep_alive);
+    EmptyResponse MakeNotModifiedFileResponse(const StaticFileCache::Entry& entry, std::string_view etag, unsigned version, bool keep_alive);
+    StringResponse MakeRangeNotSatisfiableResponse(uint64_t size, unsigned version, bool keep_alive, http::verb method);
+    // Тип, валидаторы и кодирование представления файла из кэша
+    static void SetCachedFileHeaders(http::response_header<http_server::ResponseFields>& header, const StaticFileCache::Entry& entry, const StaticFileCache::Variant* variant);
 
     template <typename Body, typename Allocator, typename Send>
     void HandleFileRequest(http::request<Body, http::basic_fields<Allocator>>&& req, Send&& send);
 
     ApiHandler api_handler_;
     fs::path static_root_;
+    StaticFileCache static_cache_;
 };
 
 template <typename Body, typename Allocator, typename Send>
@@ -93,70 +121,100 @@ void RequestHandler::HandleFileRequest(http::request<Body, http::basic_fields<Al
             decoded_path += "index.html";
         }
         
-        fs::path file_path = static_root_ / decoded_path.substr(1);
-
-        auto is_subpath = [](fs::path path, fs::path base) {
-            path = fs::weakly_canonical(path);
-            base = fs::weakly_canonical(base);
-            for (auto b = base.begin(), p = path.begin(); b != base.end(); ++b, ++p) {
-                if (p == path.end() || *p != *b) {
-                    return false;
+        fs::path file_path;
+        std::optional<ByteRange> file_range;
+        auto entry = static_cache_.Find(decoded_path);
+        if (entry) {
+            // Путь из кэша уже проверен, файловая система не опрашивается.
+            // Диапазоны выдаются только из несжатого представления: Content-Encoding
+            // ответа multipart/byteranges относился бы ко всему телу, а не к частям
+            const auto range = method == http::verb::get ? FindField(req, http::field::range) : std::nullopt;
+            const StaticFileCache::Variant* variant = nullptr;
+            if (entry->body && !entry->variants.empty() && !range) {
+                variant = entry->SelectVariant(FindField(req, http::field::accept_encoding).value_or(""sv));
+            }
+            const std::string& etag = variant ? variant->etag : entry->etag;
+            if (IsNotModified(FindField(req, http::field::if_none_match), FindField(req, http::field::if_modified_since), etag, entry->last_modified)) {
+                return send(this->MakeNotModifiedFileResponse(*entry, etag, version, keep_alive));
+            }
+
+            std::optional<std::vector<ByteRange>> ranges;
+            if (range) {
+                const auto if_range = FindField(req, http::field::if_range);
+                if (!if_range || IfRangeMatches(*if_range, etag, entry->last_modified)) {
+                    ranges = ParseRange(*range, entry->size);
                 }
             }
-            return true;
-        };
+            if (ranges && ranges->empty()) {
+                return send(this->MakeRangeNotSatisfiableResponse(entry->size, version, keep_alive, method));
+            }
+            if (entry->body) {
+                if (ranges) {
+                    return send(this->MakeCachedRangesResponse(*entry, std::move(*ranges), version, keep_alive));
+                }
+                return send(this->MakeCachedFileResponse(*entry, variant, version, keep_alive, method));
+            }
+            // Файл с диска уходит одним вызовом sendfile, поэтому на несколько диапазонов
+            // отдаётся весь файл, что RFC 9110 допускает
+            if (ranges && ranges->size() == 1) {
+                file_range = ranges->front();
+            }
+            file_path = entry->path;
+        } else {
+            file_path = static_root_ / decoded_path.substr(1);
+
+            auto is_subpath = [](fs::path path, fs::path base) {
+                path = fs::weakly_canonical(path);
+                base = fs::weakly_canonical(base);
+                for (auto b = base.begin(), p = path.begin(); b != base.end(); ++b, ++p) {
+                    if (p == path.end() || *p != *b) {
+                        return false;
+                    }
+                }
+                return true;
+            };
 
-        if (!is_subpath(file_path, static_root_)) {
-            return send(this->MakeStringResponse(http::status::bad_request, "Bad Request", version, keep_alive, method));
-        }
+            if (!is_subpath(file_path, static_root_)) {
+                return send(this->MakeStringResponse(http::status::bad_request, "Bad Request", version, keep_alive, method));
+            }
 
-        if (fs::is_directory(file_path)) {
-            file_path /= "index.html";
-        }
+            if (fs::is_directory(file_path)) {
+                file_path /= "index.html";
+            }
 
-        if (!fs::exists(file_path) || !fs::is_regular_file(file_path)) {
-            return send(this->MakeStringResponse(http::status::not_found, "File not found", version, keep_alive, method, "text/plain"));
+            if (!fs::exists(file_path) || !fs::is_regular_file(file_path)) {
+                return send(this->MakeStringResponse(http::status::not_found, "File not found", version, keep_alive, method, "text/plain"));
+            }
         }
-        
-        auto get_mime_type = [](const fs::path& path) -> std::string_view {
-            std::string ext = path.extension().string();
-            std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c){ return std::tolower(c); });
-            
-            if (ext == ".htm" || ext == ".html") return "text/html";
-            if (ext == ".css") return "text/css";
-            if (ext == ".txt") return "text/plain";
-            if (ext == ".js") return "text/javascript";
-            if (ext == ".json") return "application/json";
-            if (ext == ".xml") return "application/xml";
-            if (ext == ".png") return "image/png";
-            if (ext == ".jpg" || ext == ".jpe" || ext == ".jpeg") return "image/jpeg";
-            if (ext == ".gif") return "image/gif";
-            if (ext == ".bmp") return "image/bmp";
-            if (ext == ".ico") return "image/vnd.microsoft.icon";
-            if (ext == ".tiff" || ext == ".tif") return "image/tiff";
-            if (ext == ".svg" || ext == ".svgz") return "image/svg+xml";
-            if (ext == ".mp3") return "audio/mpeg";
-
-            return "application/octet-stream";
-        };
 
         beast::error_code ec;
         FileResponse res{http::status::ok, version};
-        res.set(http::field::content_type, std::string(get_mime_type(file_path)));
-        res.set(http::field::cache_control, "no-cache");
+        if (entry) {
+            SetCachedFileHeaders(res, *entry, nullptr);
+        } else {
+            res.set(http::field::content_type, ToHeaderValue(GetMimeType(file_path)));
+            res.set(http::field::cache_control, "no-cache");
+        }
         res.keep_alive(keep_alive);
         
         if (req.method() == http::verb::head) {
-            res.content_length(fs::file_size(file_path, ec));
+            // Размер файла из кэша уже известен, файловая система не опрашивается
+            res.content_length(entry ? entry->size : fs::file_size(file_path, ec));
             if (ec) {
                 return send(this->MakeStringResponse(http::status::internal_server_error, "Failed to get file size", version, keep_alive, method));
             }
         } else { // GET
-            http::file_body::value_type file;
-            file.open(file_path.c_str(), beast::file_mode::read, ec);
+            http_server::SendfileBody::value_type file;
+            file.open(file_path.c_str(), ec);
             if (ec) {
                 return send(this->MakeStringResponse(http::status::internal_server_error, "Failed to open file", version, keep_alive, method));
             }
+            // Файл мог уменьшиться после проверки диапазона, тогда он отдаётся целиком
+            if (file_range && file_range->last < file.size()) {
+                res.result(http::status::partial_content);
+                res.set(http::field::content_range, MakeContentRange(*file_range, file.size()));
+                file.set_range(file_range->first, file_range->GetSize());
+            }
             res.body() = std::move(file);
             res.prepare_payload();
         }
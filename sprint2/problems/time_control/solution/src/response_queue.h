@@ -0,0 +1,227 @@
+#pragma once
+#include "sendfile_body.h"
+#include "websocket_session.h"
+#include <array>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <type_traits>
+#include <vector>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+
+namespace http_server {
+
+namespace detail {
+
+// Тело, которое целиком лежит в памяти и не меняется во время записи. Буферы таких ответов
+// можно собрать заранее и отправить несколько ответов одной операцией записи.
+// Свои типы тела отмечают это полем static constexpr bool is_in_memory = true
+template <typename Body>
+concept InMemoryBody = std::is_same_v<Body, http::string_body> || std::is_same_v<Body, http::empty_body>
+    || requires { requires Body::is_in_memory; };
+
+// Ответ, ожидающий отправки в очереди соединения
+class PendingWrite {
+public:
+    using WriteHandler = std::function<void(beast::error_code, std::size_t)>;
+
+    virtual ~PendingWrite() = default;
+
+    virtual bool NeedEof() const = 0;
+    // Дописывает в buffers весь ответ, если это возможно без отдельной операции записи.
+    // Буферы остаются действительными, пока жив объект
+    virtual bool AppendBuffers(std::vector<net::const_buffer>& buffers) = 0;
+    virtual void AsyncWrite(beast::tcp_stream& stream, WriteHandler handler) = 0;
+    // Переход на другой протокол забирает поток соединения. Возвращает true, если поток забран
+    virtual bool TakeOver(beast::tcp_stream&) {
+        return false;
+    }
+};
+
+// Сколько отправка файла может ждать готовности сокета к записи. Как тайм-аут чтения в SessionBase
+inline constexpr std::chrono::seconds SEND_FILE_TIMEOUT{30};
+
+template <typename Body, typename Fields>
+class PendingResponse final : public PendingWrite {
+public:
+    explicit PendingResponse(http::response<Body, Fields>&& response)
+        : response_(std::move(response)) {
+    }
+
+    bool NeedEof() const override {
+        return response_.need_eof();
+    }
+
+    bool AppendBuffers(std::vector<net::const_buffer>& buffers) override {
+        if constexpr (InMemoryBody<Body>) {
+            // Буферы ссылаются на заголовки и тело response_, а строка статуса - на память
+            // сериализатора, который живёт до освобождения ответа после записи
+            auto& serializer = serializer_.emplace(response_);
+            const size_t first_buffer = buffers.size();
+            auto append = [&](beast::error_code&, const auto& sequence) {
+                for (net::const_buffer buffer : beast::buffers_range_ref(sequence)) {
+                    buffers.push_back(buffer);
+                }
+            };
+            beast::error_code ec;
+            if (Body::size(response_.body()) == 0) {
+                // Ответ без тела (304, HEAD) - одна последовательность буферов. Её consume()
+                // уничтожил бы строку статуса до записи, поэтому сериализатор не продвигается
+                serializer.next(ec, append);
+            } else {
+                while (!ec && !serializer.is_done()) {
+                    serializer.next(ec, [&](beast::error_code& ec, const auto& sequence) {
+                        append(ec, sequence);
+                        serializer.consume(beast::buffer_bytes(sequence));
+                    });
+                }
+            }
+            if (ec) {
+                buffers.resize(first_buffer);
+                return false;
+            }
+            return true;
+        } else {
+            return false;
+        }
+    }
+
+    void AsyncWrite(beast::tcp_stream& stream, WriteHandler handler) override {
+        if constexpr (std::is_same_v<Body, SendfileBody>) {
+            // Заголовок пишет сериализатор, а тело уходит из файла в сокет без копирования
+            auto& serializer = serializer_.emplace(response_);
+            http::async_write_header(stream, serializer,
+                                     [this, &stream, handler = std::move(handler)](beast::error_code ec, std::size_t header_bytes) mutable {
+                                         if (ec) {
+                                             return handler(ec, header_bytes);
+                                         }
+                                         const auto& body = response_.body();
+                                         AsyncSendFile(stream.socket(), body.native_handle(), body.offset(), body.size(), SEND_FILE_TIMEOUT,
+                                                       [header_bytes, handler = std::move(handler)](beast::error_code ec, std::size_t body_bytes) {
+                                                           handler(ec, header_bytes + body_bytes);
+                                                       });
+                                     });
+        } else {
+            http::async_write(stream, response_, std::move(handler));
+        }
+    }
+
+private:
+    http::response<Body, Fields> response_;
+    std::optional<http::serializer<false, Body, Fields>> serializer_;
+};
+
+class PendingUpgrade final : public PendingWrite {
+public:
+    PendingUpgrade(std::shared_ptr<WebSocketSession> ws_session, http::request<RequestBody, RequestFields>&& request)
+        : ws_session_(std::move(ws_session))
+        , request_(std::move(request)) {
+    }
+
+    bool NeedEof() const override {
+        return false;
+    }
+
+    bool AppendBuffers(std::vector<net::const_buffer>&) override {
+        return false;
+    }
+
+    void AsyncWrite(beast::tcp_stream&, WriteHandler) override {
+    }
+
+    bool TakeOver(beast::tcp_stream& stream) override {
+        ws_session_->Run(std::move(stream), std::move(request_));
+        return true;
+    }
+
+private:
+    std::shared_ptr<WebSocketSession> ws_session_;
+    http::request<RequestBody, RequestFields> request_;
+};
+
+}  // namespace detail
+
+// Ответы соединения в порядке запросов. Элементы размещаются в собственном пуле очереди
+// и возвращаются в него после записи, поэтому в установившемся режиме очередь не выделяет память.
+// Используется только в executor соединения
+class ResponseQueue {
+public:
+    // Наибольшее число запросов, ответы на которые ещё не отправлены
+    static constexpr uint64_t CAPACITY = 16;
+
+    ResponseQueue() {
+        for (size_t i = 0; i < CAPACITY; ++i) {
+            slots_[i] = SlotPtr{nullptr, Deleter{this, i}};
+        }
+    }
+
+    ResponseQueue(const ResponseQueue&) = delete;
+    ResponseQueue& operator=(const ResponseQueue&) = delete;
+
+    // Помещает ответ на запрос request_id. Номер должен быть не меньше GetFirstId()
+    // и меньше GetFirstId() + CAPACITY
+    template <typename T, typename... Args>
+    void Emplace(uint64_t request_id, Args&&... args) {
+        void* memory = pool_.allocate(sizeof(T), alignof(T));
+        try {
+            slots_[request_id % CAPACITY].reset(new (memory) T(std::forward<Args>(args)...));
+        } catch (...) {
+            pool_.deallocate(memory, sizeof(T), alignof(T));
+            throw;
+        }
+        sizes_[request_id % CAPACITY] = {sizeof(T), alignof(T)};
+    }
+
+    // Номер самого старого ответа, который ещё не записан
+    uint64_t GetFirstId() const noexcept {
+        return first_id_;
+    }
+
+    // Готов ли ответ с номером GetFirstId() + offset
+    bool IsReady(uint64_t offset) const noexcept {
+        return offset < CAPACITY && slots_[(first_id_ + offset) % CAPACITY] != nullptr;
+    }
+
+    detail::PendingWrite& Get(uint64_t offset) noexcept {
+        return *slots_[(first_id_ + offset) % CAPACITY];
+    }
+
+    // Освобождает count первых ответов после их записи
+    void Release(uint64_t count) noexcept {
+        for (; count > 0; --count, ++first_id_) {
+            slots_[first_id_ % CAPACITY].reset();
+        }
+    }
+
+    void Clear() noexcept {
+        for (auto& slot : slots_) {
+            slot.reset();
+        }
+    }
+
+private:
+    struct Deleter {
+        ResponseQueue* queue;
+        size_t index;
+
+        void operator()(detail::PendingWrite* response) const noexcept {
+            response->~PendingWrite();
+            const auto [size, alignment] = queue->sizes_[index];
+            queue->pool_.deallocate(response, size, alignment);
+        }
+    };
+    using SlotPtr = std::unique_ptr<detail::PendingWrite, Deleter>;
+
+    // Пул объявлен первым, чтобы разрушиться после элементов
+    std::pmr::unsynchronized_pool_resource pool_;
+    std::array<std::pair<size_t, size_t>, CAPACITY> sizes_{};
+    std::array<SlotPtr, CAPACITY> slots_;
+    uint64_t first_id_ = 0;
+};
+
+}  // namespace http_server
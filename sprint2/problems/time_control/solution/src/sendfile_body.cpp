@@ -0,0 +1,135 @@
+#include "sendfile_body.h"
+#include <algorithm>
+#include <cerrno>
+#include <memory>
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/beast/core/error.hpp>
+#include <sys/sendfile.h>
+
+namespace http_server {
+
+namespace {
+
+namespace sys = boost::system;
+using tcp = net::ip::tcp;
+
+class SendFileOperation : public std::enable_shared_from_this<SendFileOperation> {
+public:
+    using Handler = std::function<void(beast::error_code, std::size_t)>;
+
+    SendFileOperation(tcp::socket& socket, int fd, uint64_t offset, uint64_t size,
+                      std::chrono::steady_clock::duration timeout, Handler handler)
+        : socket_(socket)
+        , fd_(fd)
+        , offset_(offset)
+        , remaining_(size)
+        , timeout_(timeout)
+        , timer_(socket.get_executor())
+        , handler_(std::move(handler)) {
+    }
+
+    // initial - вызов из функции, начавшей операцию
+    void Send(bool initial) {
+        while (remaining_ > 0) {
+            off_t offset = static_cast<off_t>(offset_);
+            const ssize_t sent = ::sendfile(socket_.native_handle(), fd_, &offset, std::min(remaining_, MAX_CHUNK));
+            if (sent > 0) {
+                offset_ += sent;
+                remaining_ -= sent;
+                written_ += sent;
+                continue;
+            }
+            if (sent == 0) {
+                // Файл стал короче объявленного размера
+                return Complete(http::error::short_read, initial);
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                // Буфер сокета заполнен: продолжим, когда в него снова можно будет писать
+                return Wait();
+            }
+            return Complete(sys::error_code{errno, sys::system_category()}, initial);
+        }
+        Complete({}, initial);
+    }
+
+private:
+    // Ограничивает работу одного вызова sendfile
+    static constexpr uint64_t MAX_CHUNK = uint64_t{1} << 20;
+
+    // Ждёт готовности сокета к записи не дольше timeout_. Клиент, который перестал
+    // читать, иначе удерживал бы соединение бесконечно
+    void Wait() {
+        const uint64_t wait_id = ++wait_id_;
+        waiting_ = true;
+        timer_.expires_after(timeout_);
+        timer_.async_wait([self = shared_from_this(), wait_id](sys::error_code ec) {
+            // Ожидание могло завершиться раньше, чем обработчик таймера успел выполниться
+            if (!ec && self->waiting_ && self->wait_id_ == wait_id) {
+                self->timed_out_ = true;
+                sys::error_code ignored;
+                self->socket_.cancel(ignored);
+            }
+        });
+        socket_.async_wait(tcp::socket::wait_write, [self = shared_from_this()](sys::error_code ec) {
+            self->waiting_ = false;
+            self->timer_.cancel();
+            if (self->timed_out_) {
+                return self->Complete(beast::error::timeout, false);
+            }
+            if (ec) {
+                return self->Complete(ec, false);
+            }
+            self->Send(false);
+        });
+    }
+
+    void Complete(beast::error_code ec, bool initial) {
+        // Синхронные операции с сокетом после отправки файла снова должны блокироваться
+        sys::error_code ignored;
+        socket_.non_blocking(false, ignored);
+        if (initial) {
+            // Обработчик не вызывается из функции, начавшей операцию
+            net::post(socket_.get_executor(), [handler = std::move(handler_), ec, written = written_] {
+                handler(ec, written);
+            });
+        } else {
+            handler_(ec, written_);
+        }
+    }
+
+    tcp::socket& socket_;
+    int fd_;
+    uint64_t offset_;
+    uint64_t remaining_;
+    std::size_t written_ = 0;
+    std::chrono::steady_clock::duration timeout_;
+    net::steady_timer timer_;
+    // Номер текущего ожидания готовности сокета. Отличает срабатывание таймера от устаревшего
+    uint64_t wait_id_ = 0;
+    bool waiting_ = false;
+    bool timed_out_ = false;
+    Handler handler_;
+};
+
+}  // namespace
+
+void AsyncSendFile(tcp::socket& socket, int fd, uint64_t offset, uint64_t size,
+                   std::chrono::steady_clock::duration timeout,
+                   std::function<void(beast::error_code, std::size_t)> handler) {
+    beast::error_code ec;
+    // Асинхронные операции Asio не зависят от этого флага, а sendfile без него заблокирует поток.
+    // По завершении операции флаг снимается
+    socket.non_blocking(true, ec);
+    if (ec) {
+        return net::post(socket.get_executor(), [handler = std::move(handler), ec] {
+            handler(ec, 0);
+        });
+    }
+    std::make_shared<SendFileOperation>(socket, fd, offset, size, timeout, std::move(handler))->Send(true);
+}
+
+}  // namespace http_server
@@ -0,0 +1,122 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core/error.hpp>
+#include <boost/beast/core/file_posix.hpp>
+#include <boost/beast/http/error.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/optional.hpp>
+
+namespace http_server {
+
+namespace net = boost::asio;
+namespace beast = boost::beast;
+namespace http = beast::http;
+
+// Тело ответа из файла. Соединение отправляет его через sendfile(2) прямо из файла
+// в сокет, минуя буферы процесса (см. detail::PendingResponse). Сериализатор Beast
+// по-прежнему может записать такое тело обычным чтением файла
+struct SendfileBody {
+    class value_type {
+    public:
+        bool is_open() const {
+            return file_.is_open();
+        }
+
+        // Открывает файл на чтение, телом становится весь файл
+        void open(const char* path, beast::error_code& ec) {
+            file_.open(path, beast::file_mode::read, ec);
+            size_ = ec ? 0 : file_.size(ec);
+            if (ec) {
+                file_.close(ec);
+                size_ = 0;
+            }
+        }
+
+        // Оставляет от открытого файла size байт, начиная с offset. Для ответов 206,
+        // диапазон должен быть уже проверен по размеру файла
+        void set_range(uint64_t offset, uint64_t size) noexcept {
+            offset_ = offset;
+            size_ = size;
+        }
+
+        int native_handle() const {
+            return file_.native_handle();
+        }
+
+        uint64_t offset() const noexcept {
+            return offset_;
+        }
+
+        uint64_t size() const noexcept {
+            return size_;
+        }
+
+    private:
+        friend struct SendfileBody;
+
+        beast::file_posix file_;
+        uint64_t offset_ = 0;
+        uint64_t size_ = 0;
+    };
+
+    static uint64_t size(const value_type& body) {
+        return body.size();
+    }
+
+    class writer {
+    public:
+        using const_buffers_type = net::const_buffer;
+
+        template <bool isRequest, class Fields>
+        writer(http::header<isRequest, Fields>&, value_type& body)
+            : body_(body) {
+        }
+
+        void init(beast::error_code& ec) {
+            remaining_ = body_.size_;
+            if (body_.is_open()) {
+                body_.file_.seek(body_.offset_, ec);
+            } else {
+                ec = {};
+            }
+        }
+
+        boost::optional<std::pair<const_buffers_type, bool>> get(beast::error_code& ec) {
+            if (remaining_ == 0) {
+                ec = {};
+                return boost::none;
+            }
+            const size_t amount = remaining_ < sizeof(buffer_) ? static_cast<size_t>(remaining_) : sizeof(buffer_);
+            const size_t read = body_.file_.read(buffer_, amount, ec);
+            if (ec) {
+                return boost::none;
+            }
+            if (read == 0) {
+                // Файл стал короче объявленного размера
+                ec = http::error::short_read;
+                return boost::none;
+            }
+            remaining_ -= read;
+            return {{const_buffers_type{buffer_, read}, remaining_ > 0}};
+        }
+
+    private:
+        value_type& body_;
+        uint64_t remaining_ = 0;
+        // Как у http::file_body
+        char buffer_[4096];
+    };
+};
+
+// Асинхронно отправляет size байт файла fd, начиная с offset, в сокет через sendfile(2).
+// Частичные записи продолжаются после готовности сокета к записи. Если сокет не готов
+// к записи дольше timeout, операция завершается с beast::error::timeout. handler вызывается
+// через executor сокета с числом отправленных байт, даже если всё отправлено сразу
+void AsyncSendFile(net::ip::tcp::socket& socket, int fd, uint64_t offset, uint64_t size,
+                   std::chrono::steady_clock::duration timeout,
+                   std::function<void(beast::error_code, std::size_t)> handler);
+
+}  // namespace http_server
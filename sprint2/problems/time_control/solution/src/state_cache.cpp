@@ -0,0 +1,29 @@
+#include "state_cache.h"
+#include "binary_serializer.h"
+#include "json_serializer.h"
+
+namespace http_handler {
+
+std::shared_ptr<const std::string> StateCache::GetState(const model::GameSession& session, StateFormat format) {
+    Entry* entry = nullptr;
+    {
+        std::lock_guard lock{mutex_};
+        // Ссылки на элементы unordered_map не инвалидируются при вставке
+        entry = &entries_[&session];
+    }
+
+    Encoded& encoded = (*entry)[static_cast<size_t>(format)];
+    if (!encoded.state || encoded.version != session.GetVersion()) {
+        std::string state;
+        if (format == StateFormat::BINARY) {
+            binary_serializer::AppendGameState(state, session.GetDogs());
+        } else {
+            json_serializer::AppendGameState(state, session.GetDogs());
+        }
+        encoded.state = std::make_shared<const std::string>(std::move(state));
+        encoded.version = session.GetVersion();
+    }
+    return encoded.state;
+}
+
+}  // namespace http_handler
@@ -0,0 +1,37 @@
+#pragma once
+#include "model.h"
+#include <array>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace http_handler {
+
+enum class StateFormat {
+    JSON,
+    // Компактное двоичное представление из binary_serializer
+    BINARY,
+};
+
+// Сериализованное состояние игровых сессий. Пока версия сессии не изменилась,
+// все читатели получают один и тот же неизменяемый буфер
+class StateCache {
+public:
+    // Вызывается в strand сессии
+    std::shared_ptr<const std::string> GetState(const model::GameSession& session, StateFormat format = StateFormat::JSON);
+
+private:
+    struct Encoded {
+        uint64_t version = 0;
+        std::shared_ptr<const std::string> state;
+    };
+    // Представления сессии в каждом из форматов обновляются независимо
+    using Entry = std::array<Encoded, 2>;
+
+    // Защищает только структуру entries_: запись сессии меняется лишь в её strand
+    std::mutex mutex_;
+    std::unordered_map<const model::GameSession*, Entry> entries_;
+};
+
+}  // namespace http_handler
@@ -0,0 +1,15 @@
+#include "state_subscribers.h"
+
+namespace http_handler {
+
+void StateSubscribers::Add(const model::GameSession& session, const Subscriber& subscriber, StateFormat format) {
+    GetSubscriptions(session).push_back({subscriber, format});
+}
+
+std::vector<StateSubscribers::Subscription>& StateSubscribers::GetSubscriptions(const model::GameSession& session) {
+    std::lock_guard lock{mutex_};
+    // Ссылки на элементы unordered_map не инвалидируются при вставке
+    return subscriptions_[&session];
+}
+
+}  // namespace http_handler
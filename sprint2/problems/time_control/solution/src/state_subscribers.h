@@ -0,0 +1,62 @@
+#pragma once
+#include "model.h"
+#include "state_cache.h"
+#include "websocket_session.h"
+#include <array>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace http_handler {
+
+// Игроки, получающие состояние своей сессии по WebSocket после каждого тика
+class StateSubscribers {
+public:
+    using Subscriber = std::shared_ptr<http_server::WebSocketSession>;
+
+    // Вызывается в strand сессии
+    void Add(const model::GameSession& session, const Subscriber& subscriber, StateFormat format = StateFormat::JSON);
+
+    // Вызывается в strand сессии. make_frame(format) вызывается не более одного раза
+    // на каждый формат, нужный подписчикам, и один и тот же буфер отправляется всем.
+    // Закрытые соединения отписываются
+    template <typename MakeFrame>
+    void Publish(const model::GameSession& session, MakeFrame&& make_frame);
+
+private:
+    struct Subscription {
+        std::weak_ptr<http_server::WebSocketSession> subscriber;
+        StateFormat format;
+    };
+
+    std::vector<Subscription>& GetSubscriptions(const model::GameSession& session);
+
+    // Защищает только структуру subscriptions_: список сессии меняется лишь в её strand
+    std::mutex mutex_;
+    std::unordered_map<const model::GameSession*, std::vector<Subscription>> subscriptions_;
+};
+
+template <typename MakeFrame>
+void StateSubscribers::Publish(const model::GameSession& session, MakeFrame&& make_frame) {
+    auto& subscriptions = GetSubscriptions(session);
+    std::erase_if(subscriptions, [](const Subscription& subscription) {
+        const auto subscriber = subscription.subscriber.lock();
+        return !subscriber || subscriber->IsClosed();
+    });
+
+    std::array<http_server::WebSocketSession::Frame, 2> frames;
+    for (const Subscription& subscription : subscriptions) {
+        const auto subscriber = subscription.subscriber.lock();
+        if (!subscriber) {
+            continue;
+        }
+        auto& frame = frames[static_cast<size_t>(subscription.format)];
+        if (!frame) {
+            frame = make_frame(subscription.format);
+        }
+        subscriber->Send(frame, subscription.format == StateFormat::BINARY);
+    }
+}
+
+}  // namespace http_handler
@@ -0,0 +1,386 @@
+#include "static_file_cache.h"
+#include "content_negotiation.h"
+#include "http_cache.h"
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/system/system_error.hpp>
+#ifdef __linux__
+#include <boost/asio/posix/stream_descriptor.hpp>
+#include <sys/inotify.h>
+#endif
+
+namespace http_handler {
+
+namespace sys = boost::system;
+
+namespace {
+
+bool IsSubpath(const fs::path& path, const fs::path& base) {
+    auto p = path.begin();
+    for (auto b = base.begin(); b != base.end(); ++b, ++p) {
+        if (p == path.end() || *p != *b) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::shared_ptr<const std::string> ReadFile(const fs::path& path, uint64_t size) {
+    std::string content(size, '\0');
+    std::ifstream file{path, std::ios::binary};
+    if (!file.read(content.data(), static_cast<std::streamsize>(size))) {
+        return nullptr;
+    }
+    return std::make_shared<const std::string>(std::move(content));
+}
+
+// Файлы меньше этого размера не сжимаются: выигрыш не окупает Content-Encoding
+constexpr uint64_t MIN_COMPRESSIBLE_SIZE = 256;
+
+bool IsCompressible(const fs::path& path, std::string_view content_type) {
+    if (path.extension() == ".svgz") {
+        return false;
+    }
+    return content_type.starts_with("text/") || content_type == "application/json"
+        || content_type == "application/xml" || content_type == "image/svg+xml";
+}
+
+std::shared_ptr<const std::string> Gzip(const std::string& content) {
+    namespace io = boost::iostreams;
+    std::string compressed;
+    {
+        io::filtering_ostream out;
+        out.push(io::gzip_compressor{io::gzip_params{io::gzip::best_compression}});
+        out.push(io::back_inserter(compressed));
+        out.write(content.data(), static_cast<std::streamsize>(content.size()));
+    }
+    return std::make_shared<const std::string>(std::move(compressed));
+}
+
+size_t GetMemorySize(const StaticFileCache::Entry& entry) {
+    size_t size = entry.body ? entry.body->size() : 0;
+    for (const auto& variant : entry.variants) {
+        size += variant.body->size();
+    }
+    return size;
+}
+
+// Добавляет к файлу в памяти сжатые варианты, не выходя за budget байт.
+// Готовые соседние файлы предпочтительнее: их можно сжать сильнее или brotli
+void AddVariants(StaticFileCache::Entry& entry, uint64_t budget) {
+    auto add = [&](std::string_view encoding, std::shared_ptr<const std::string> body) {
+        // Вариант не меньше исходного файла бесполезен
+        if (body && body->size() < entry.size && body->size() <= budget) {
+            budget -= body->size();
+            std::string etag = MakeStrongETag(*body);
+            entry.variants.push_back({encoding, std::move(body), std::move(etag)});
+        }
+    };
+    auto read_sibling = [&](std::string_view extension) -> std::shared_ptr<const std::string> {
+        fs::path sibling = entry.path;
+        sibling += extension;
+        std::error_code ec;
+        const uint64_t size = fs::file_size(sibling, ec);
+        if (ec || !fs::is_regular_file(sibling, ec) || size > budget) {
+            return nullptr;
+        }
+        return ReadFile(sibling, size);
+    };
+
+    add("br", read_sibling(".br"));
+    if (auto gzip = read_sibling(".gz")) {
+        add("gzip", std::move(gzip));
+    } else if (entry.size >= MIN_COMPRESSIBLE_SIZE && IsCompressible(entry.path, entry.content_type)) {
+        add("gzip", Gzip(*entry.body));
+    }
+}
+
+// Описание обычного файла внутри root. Содержимое и сжатые варианты читаются,
+// если вместе они не больше budget. Возвращает nullptr, если файла нет или он ведёт за пределы root
+std::shared_ptr<StaticFileCache::Entry> LoadEntry(const fs::path& path, const fs::path& root, uint64_t budget) {
+    std::error_code ec;
+    auto entry = std::make_shared<StaticFileCache::Entry>();
+    entry->path = fs::canonical(path, ec);
+    if (ec || !fs::is_regular_file(entry->path, ec) || !IsSubpath(entry->path, root)) {
+        return nullptr;
+    }
+    entry->size = fs::file_size(entry->path, ec);
+    if (ec) {
+        return nullptr;
+    }
+    const auto mtime = fs::last_write_time(entry->path, ec);
+    if (ec) {
+        return nullptr;
+    }
+    entry->last_modified = std::chrono::floor<std::chrono::seconds>(std::chrono::file_clock::to_sys(mtime));
+    entry->last_modified_text = FormatHttpDate(entry->last_modified);
+    entry->content_type = GetMimeType(entry->path);
+    if (entry->size <= budget) {
+        entry->body = ReadFile(entry->path, entry->size);
+    }
+    if (entry->body && entry->body->size() == entry->size) {
+        entry->etag = MakeStrongETag(*entry->body);
+        AddVariants(*entry, budget - entry->size);
+    } else {
+        // Большие файлы не читаются целиком ради хэша, их ETag зависит от размера и времени изменения
+        entry->body.reset();
+        const auto mtime_ns = std::chrono::file_clock::to_sys(mtime).time_since_epoch().count();
+        entry->etag = "W/\"" + std::to_string(entry->size) + '-' + std::to_string(mtime_ns) + '"';
+    }
+    return entry;
+}
+
+}  // namespace
+
+std::string_view GetMimeType(const fs::path& path) {
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c){ return std::tolower(c); });
+
+    if (ext == ".htm" || ext == ".html") return "text/html";
+    if (ext == ".css") return "text/css";
+    if (ext == ".txt") return "text/plain";
+    if (ext == ".js") return "text/javascript";
+    if (ext == ".json") return "application/json";
+    if (ext == ".xml") return "application/xml";
+    if (ext == ".png") return "image/png";
+    if (ext == ".jpg" || ext == ".jpe" || ext == ".jpeg") return "image/jpeg";
+    if (ext == ".gif") return "image/gif";
+    if (ext == ".bmp") return "image/bmp";
+    if (ext == ".ico") return "image/vnd.microsoft.icon";
+    if (ext == ".tiff" || ext == ".tif") return "image/tiff";
+    if (ext == ".svg" || ext == ".svgz") return "image/svg+xml";
+    if (ext == ".mp3") return "audio/mpeg";
+
+    return "application/octet-stream";
+}
+
+#ifdef __linux__
+
+// Следит за каталогами дерева через inotify. Изменённые файлы перечитываются,
+// а при изменении набора каталогов или переполнении очереди событий дерево просматривается заново.
+// Все методы, кроме конструктора, вызываются последовательно в цепочке чтения событий
+class StaticFileCache::Watcher {
+public:
+    Watcher(StaticFileCache& cache, net::io_context& ioc)
+        : cache_(cache)
+        , descriptor_(ioc) {
+        const int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd < 0) {
+            throw sys::system_error(errno, sys::system_category(), "inotify_init1");
+        }
+        descriptor_.assign(fd);
+        WatchTree();
+    }
+
+    void Run() {
+        descriptor_.async_read_some(net::buffer(buffer_), [this](sys::error_code ec, size_t bytes_read) {
+            if (ec) {
+                if (ec != net::error::operation_aborted) {
+                    std::cerr << "static files watch: " << ec.message() << std::endl;
+                }
+                return;
+            }
+            OnEvents(bytes_read);
+            Run();
+        });
+    }
+
+private:
+    static constexpr uint32_t FILE_EVENTS = IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | IN_CREATE | IN_DELETE
+        | IN_MOVED_FROM | IN_MOVED_TO;
+    static constexpr uint32_t DIRECTORY_EVENTS = IN_DELETE_SELF | IN_MOVE_SELF;
+
+    void WatchTree() {
+        AddWatch(cache_.root_);
+        std::error_code ec;
+        for (auto it = fs::recursive_directory_iterator(cache_.root_, ec); !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+            if (it->is_directory(ec)) {
+                AddWatch(it->path());
+            }
+        }
+    }
+
+    void AddWatch(const fs::path& directory) {
+        const int wd = inotify_add_watch(descriptor_.native_handle(), directory.c_str(), FILE_EVENTS | DIRECTORY_EVENTS);
+        if (wd >= 0) {
+            directories_[wd] = directory;
+        }
+    }
+
+    void OnEvents(size_t bytes_read) {
+        bool rebuild = false;
+        for (size_t offset = 0; offset < bytes_read;) {
+            const auto* event = reinterpret_cast<const inotify_event*>(buffer_.data() + offset);
+            offset += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_IGNORED) {
+                directories_.erase(event->wd);
+                continue;
+            }
+            const auto directory = directories_.find(event->wd);
+            if ((event->mask & (IN_Q_OVERFLOW | IN_ISDIR | DIRECTORY_EVENTS)) || directory == directories_.end()) {
+                rebuild = true;
+                continue;
+            }
+            if (event->len == 0) {
+                continue;
+            }
+            const fs::path path = directory->second / event->name;
+            // Сжатый соседний файл входит в описание исходного, которое тоже нужно обновить
+            const bool is_variant = path.extension() == ".gz" || path.extension() == ".br";
+            if (event->mask & IN_MODIFY) {
+                // Файл ещё пишется: до IN_CLOSE_WRITE его отдаёт запасной путь с диска
+                std::unique_lock lock{cache_.mutex_};
+                cache_.Erase(cache_.MakeKey(path));
+                if (is_variant) {
+                    cache_.Erase(cache_.MakeKey(path.parent_path() / path.stem()));
+                }
+            } else {
+                cache_.Update(path);
+                if (is_variant) {
+                    cache_.Update(path.parent_path() / path.stem());
+                }
+            }
+        }
+        if (rebuild) {
+            WatchTree();
+            cache_.Rebuild();
+        }
+    }
+
+    StaticFileCache& cache_;
+    net::posix::stream_descriptor descriptor_;
+    alignas(inotify_event) std::array<char, 64 * 1024> buffer_;
+    std::unordered_map<int, fs::path> directories_;
+};
+
+#else
+
+class StaticFileCache::Watcher {
+public:
+    Watcher(StaticFileCache&, net::io_context&) {
+        throw sys::system_error(sys::errc::make_error_code(sys::errc::not_supported), "inotify");
+    }
+
+    void Run() {
+    }
+};
+
+#endif
+
+const StaticFileCache::Variant* StaticFileCache::Entry::SelectVariant(std::string_view accept_encoding) const {
+    const Variant* best = nullptr;
+    double best_quality = GetEncodingQuality(accept_encoding, "identity");
+    for (const auto& variant : variants) {
+        // При равном весе сжатый вариант лучше исходного файла
+        const double quality = GetEncodingQuality(accept_encoding, variant.encoding);
+        if (quality > 0 && (quality > best_quality || (quality == best_quality && best == nullptr))) {
+            best = &variant;
+            best_quality = quality;
+        }
+    }
+    return best;
+}
+
+StaticFileCache::StaticFileCache(fs::path root, size_t max_total_size, size_t max_file_size)
+    : root_(fs::weakly_canonical(root))
+    , max_total_size_(max_total_size)
+    , max_file_size_(max_file_size) {
+    Rebuild();
+}
+
+StaticFileCache::~StaticFileCache() = default;
+
+std::shared_ptr<const StaticFileCache::Entry> StaticFileCache::Find(std::string_view target) const {
+    std::shared_lock lock{mutex_};
+    if (auto it = entries_.find(target); it != entries_.end()) {
+        return it->second;
+    }
+    // Запрос к каталогу без завершающего '/'. Промах и так ведёт к обращению к диску,
+    // поэтому лишняя строка здесь ничего не стоит
+    std::string index{target};
+    if (!index.ends_with('/')) {
+        index += '/';
+    }
+    index += "index.html";
+    if (auto it = entries_.find(index); it != entries_.end()) {
+        return it->second;
+    }
+    return nullptr;
+}
+
+size_t StaticFileCache::GetCachedSize() const {
+    std::shared_lock lock{mutex_};
+    return cached_size_;
+}
+
+void StaticFileCache::Watch(net::io_context& ioc) {
+    watcher_ = std::make_unique<Watcher>(*this, ioc);
+    // События, случившиеся до начала наблюдения, учитываем повторным просмотром
+    Rebuild();
+    watcher_->Run();
+}
+
+void StaticFileCache::Rebuild() {
+    Entries entries;
+    size_t cached_size = 0;
+    std::error_code ec;
+    for (auto it = fs::recursive_directory_iterator(root_, ec); !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+        const size_t budget = std::min(max_file_size_, max_total_size_ - cached_size);
+        if (auto entry = LoadEntry(it->path(), root_, budget)) {
+            cached_size += GetMemorySize(*entry);
+            entries.emplace(MakeKey(it->path()), std::move(entry));
+        }
+    }
+
+    std::unique_lock lock{mutex_};
+    entries_ = std::move(entries);
+    cached_size_ = cached_size;
+}
+
+void StaticFileCache::Update(const fs::path& path) {
+    std::string key = MakeKey(path);
+    // Кэш меняет только цепочка событий Watcher, поэтому размер можно читать до загрузки файла
+    size_t budget = 0;
+    {
+        std::shared_lock lock{mutex_};
+        size_t old_size = 0;
+        if (auto it = entries_.find(key); it != entries_.end()) {
+            old_size = GetMemorySize(*it->second);
+        }
+        budget = std::min(max_file_size_, max_total_size_ - (cached_size_ - old_size));
+    }
+    auto entry = LoadEntry(path, root_, budget);
+
+    std::unique_lock lock{mutex_};
+    if (entry) {
+        Put(std::move(key), std::move(entry));
+    } else {
+        Erase(key);
+    }
+}
+
+std::string StaticFileCache::MakeKey(const fs::path& path) const {
+    return '/' + path.lexically_relative(root_).generic_string();
+}
+
+void StaticFileCache::Put(std::string key, std::shared_ptr<const Entry> entry) {
+    Erase(key);
+    cached_size_ += GetMemorySize(*entry);
+    entries_.emplace(std::move(key), std::move(entry));
+}
+
+void StaticFileCache::Erase(std::string_view key) {
+    if (auto it = entries_.find(key); it != entries_.end()) {
+        cached_size_ -= GetMemorySize(*it->second);
+        entries_.erase(it);
+    }
+}
+
+}  // namespace http_handler
@@ -0,0 +1,107 @@
+#pragma once
+#include <boost/asio/io_context.hpp>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace http_handler {
+
+namespace fs = std::filesystem;
+namespace net = boost::asio;
+
+// MIME-тип файла по его расширению
+std::string_view GetMimeType(const fs::path& path);
+
+// Каталог статических файлов, просмотренный при запуске. Для каждого файла хранится
+// проверенный канонический путь, MIME-тип и ETag, а для файлов в пределах лимитов -
+// ещё и содержимое, которое отдаётся всем клиентам из общих неизменяемых буферов.
+// Для таких файлов готовятся и сжатые варианты: gzip для текстовых типов, а также
+// соседние файлы .br и .gz, если они есть на диске
+class StaticFileCache {
+public:
+    // Сжатое представление файла
+    struct Variant {
+        // Значение Content-Encoding
+        std::string_view encoding;
+        std::shared_ptr<const std::string> body;
+        std::string etag;
+    };
+
+    struct Entry {
+        // Канонический путь к файлу внутри корня
+        fs::path path;
+        std::string_view content_type;
+        uint64_t size = 0;
+        std::string etag;
+        // Время изменения файла с точностью до секунды, как в Last-Modified
+        std::chrono::sys_seconds last_modified;
+        // То же время в формате HTTP-даты для заголовка Last-Modified
+        std::string last_modified_text;
+        // Пустой, если файл не поместился в лимиты и читается с диска
+        std::shared_ptr<const std::string> body;
+        // В порядке предпочтения, только при непустом body
+        std::vector<Variant> variants;
+
+        // Лучший вариант для заголовка Accept-Encoding или nullptr, если лучше отдать файл как есть
+        const Variant* SelectVariant(std::string_view accept_encoding) const;
+    };
+
+    static constexpr size_t DEFAULT_MAX_TOTAL_SIZE = size_t{64} << 20;
+    static constexpr size_t DEFAULT_MAX_FILE_SIZE = size_t{8} << 20;
+
+    explicit StaticFileCache(fs::path root, size_t max_total_size = DEFAULT_MAX_TOTAL_SIZE,
+                             size_t max_file_size = DEFAULT_MAX_FILE_SIZE);
+    ~StaticFileCache();
+
+    StaticFileCache(const StaticFileCache&) = delete;
+    StaticFileCache& operator=(const StaticFileCache&) = delete;
+
+    // target - декодированный путь запроса, начинающийся с '/'. Для каталога возвращает
+    // его index.html. Файлы, появившиеся после запуска, находятся только в режиме Watch.
+    // Можно вызывать из любого потока
+    std::shared_ptr<const Entry> Find(std::string_view target) const;
+
+    // Суммарный размер содержимого в памяти
+    size_t GetCachedSize() const;
+
+    // Включает обновление кэша по событиям inotify. События обрабатываются в потоках ioc.
+    // Бросает sys::system_error, если inotify недоступен
+    void Watch(net::io_context& ioc);
+
+private:
+    struct StringHasher {
+        using is_transparent = void;
+        size_t operator()(std::string_view s) const noexcept {
+            return std::hash<std::string_view>{}(s);
+        }
+    };
+    using Entries = std::unordered_map<std::string, std::shared_ptr<const Entry>, StringHasher, std::equal_to<>>;
+    class Watcher;
+
+    // Перечитывает весь каталог
+    void Rebuild();
+    // Перечитывает один файл или удаляет его из кэша, если файла больше нет
+    void Update(const fs::path& path);
+    std::string MakeKey(const fs::path& path) const;
+    // Put и Erase вызываются под исключительной блокировкой mutex_
+    void Put(std::string key, std::shared_ptr<const Entry> entry);
+    void Erase(std::string_view key);
+
+    fs::path root_;
+    size_t max_total_size_;
+    size_t max_file_size_;
+
+    mutable std::shared_mutex mutex_;
+    Entries entries_;
+    size_t cached_size_ = 0;
+
+    std::unique_ptr<Watcher> watcher_;
+};
+
+}  // namespace http_handler
@@ -0,0 +1,60 @@
+#include "ticker.h"
+
+#include <boost/asio/bind_executor.hpp>
+#include <boost/asio/dispatch.hpp>
+
+namespace app {
+
+Ticker::Ticker(Strand strand, std::chrono::milliseconds period, Handler handler)
+    : strand_{std::move(strand)}
+    , period_{period}
+    , handler_{std::move(handler)} {
+}
+
+void Ticker::Start() {
+    net::dispatch(strand_, [self = shared_from_this()] {
+        self->last_tick_ = self->next_tick_ = Clock::now();
+        self->ScheduleTick();
+    });
+}
+
+void Ticker::Stop() {
+    net::dispatch(strand_, [self = shared_from_this()] {
+        // Незавершённое срабатывание не должно запланировать следующее
+        self->stopped_ = true;
+        self->timer_.cancel();
+    });
+}
+
+void Ticker::ScheduleTick() {
+    if (stopped_) {
+        return;
+    }
+    next_tick_ += period_;
+    const auto now = Clock::now();
+    if (next_tick_ < now) {
+        // Обработчик не успевает за периодом. Пропущенные срабатывания не догоняем:
+        // прошедшее время и так попадёт в delta следующего вызова
+        next_tick_ = now;
+    }
+    timer_.expires_at(next_tick_);
+    timer_.async_wait(net::bind_executor(strand_, [self = shared_from_this()](sys::error_code ec) {
+        self->OnTick(ec);
+    }));
+}
+
+void Ticker::OnTick(sys::error_code ec) {
+    if (ec || stopped_) {
+        return;
+    }
+    const auto delta = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - last_tick_);
+    // Сдвигаемся ровно на переданное время, чтобы доли миллисекунды перешли в следующий тик
+    last_tick_ += delta;
+    handler_(delta, [self = shared_from_this()] {
+        net::dispatch(self->strand_, [self] {
+            self->ScheduleTick();
+        });
+    });
+}
+
+}  // namespace app
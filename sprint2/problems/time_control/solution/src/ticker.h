@@ -0,0 +1,45 @@
+#pragma once
+#include <chrono>
+#include <functional>
+#include <memory>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
+
+namespace app {
+
+namespace net = boost::asio;
+namespace sys = boost::system;
+
+// Периодически вызывает обработчик в заданном strand, передавая ему реально прошедшее время.
+// Моменты срабатывания отсчитываются от момента запуска, поэтому задержки отдельных
+// срабатываний не накапливаются. Следующее срабатывание планируется только после того,
+// как обработчик вызовет done, поэтому тики не накладываются друг на друга
+class Ticker : public std::enable_shared_from_this<Ticker> {
+public:
+    using Strand = net::strand<net::io_context::executor_type>;
+    using Clock = std::chrono::steady_clock;
+    // Сообщает о завершении срабатывания. Можно вызвать из любого потока
+    using Done = std::function<void()>;
+    using Handler = std::function<void(std::chrono::milliseconds delta, Done done)>;
+
+    Ticker(Strand strand, std::chrono::milliseconds period, Handler handler);
+
+    void Start();
+    void Stop();
+
+private:
+    void ScheduleTick();
+    void OnTick(sys::error_code ec);
+
+    Strand strand_;
+    net::steady_timer timer_{strand_};
+    std::chrono::milliseconds period_;
+    Handler handler_;
+    Clock::time_point last_tick_;
+    Clock::time_point next_tick_;
+    bool stopped_ = false;
+};
+
+}  // namespace app
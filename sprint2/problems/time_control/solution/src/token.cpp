@@ -0,0 +1,169 @@
+#include "token.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define TOKEN_HAS_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace app {
+
+namespace {
+
+#ifdef TOKEN_HAS_SSE2
+
+// 16 байт в big-endian порядке -> 32 ASCII-символа
+void EncodeHex(const uint8_t* bytes, char* out) {
+    const __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes));
+    const __m128i low_mask = _mm_set1_epi8(0x0F);
+    const __m128i high_nibbles = _mm_and_si128(_mm_srli_epi16(input, 4), low_mask);
+    const __m128i low_nibbles = _mm_and_si128(input, low_mask);
+
+    auto to_ascii = [](__m128i nibbles) {
+        // '0' + n для цифр и 'a' + n - 10 для букв
+        const __m128i is_letter = _mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9));
+        const __m128i ascii = _mm_add_epi8(nibbles, _mm_set1_epi8('0'));
+        return _mm_add_epi8(ascii, _mm_and_si128(is_letter, _mm_set1_epi8('a' - '0' - 10)));
+    };
+
+    // Старший полубайт каждого байта идёт первым
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), to_ascii(_mm_unpacklo_epi8(high_nibbles, low_nibbles)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16), to_ascii(_mm_unpackhi_epi8(high_nibbles, low_nibbles)));
+}
+
+// 16 ASCII-символов -> 8 байт. Возвращает false, если встретилась не шестнадцатеричная цифра
+bool DecodeHex16(const char* hex, uint8_t* out) {
+    const __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hex));
+
+    // Для знаковых сравнений сдвигаем диапазон: x in [lo, hi] <=> x - lo + 128 in [-128, hi - lo - 128]
+    auto in_range = [](__m128i chars, char lo, char hi) {
+        const __m128i shifted = _mm_sub_epi8(chars, _mm_set1_epi8(static_cast<char>(lo + 128)));
+        return _mm_cmplt_epi8(shifted, _mm_set1_epi8(static_cast<char>(hi - lo + 1 - 128)));
+    };
+
+    const __m128i lower = _mm_or_si128(input, _mm_set1_epi8(0x20));
+    const __m128i is_digit = in_range(input, '0', '9');
+    const __m128i is_letter = in_range(lower, 'a', 'f');
+    if (_mm_movemask_epi8(_mm_or_si128(is_digit, is_letter)) != 0xFFFF) {
+        return false;
+    }
+
+    const __m128i digits = _mm_and_si128(is_digit, _mm_sub_epi8(input, _mm_set1_epi8('0')));
+    const __m128i letters = _mm_and_si128(is_letter, _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10)));
+    const __m128i nibbles = _mm_or_si128(digits, letters);
+
+    // В каждом 16-битном слове младший байт - старший полубайт результата
+    const __m128i high = _mm_slli_epi16(_mm_and_si128(nibbles, _mm_set1_epi16(0x00FF)), 4);
+    const __m128i low = _mm_srli_epi16(nibbles, 8);
+    const __m128i packed = _mm_packus_epi16(_mm_or_si128(high, low), _mm_setzero_si128());
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(out), packed);
+    return true;
+}
+
+bool DecodeHex(const char* hex, uint8_t* out) {
+    return DecodeHex16(hex, out) && DecodeHex16(hex + 16, out + 8);
+}
+
+#else
+
+void EncodeHex(const uint8_t* bytes, char* out) {
+    constexpr char DIGITS[] = "0123456789abcdef";
+    for (size_t i = 0; i < Token::HEX_SIZE / 2; ++i) {
+        out[2 * i] = DIGITS[bytes[i] >> 4];
+        out[2 * i + 1] = DIGITS[bytes[i] & 0x0F];
+    }
+}
+
+int HexValue(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    c = static_cast<char>(c | 0x20);
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+bool DecodeHex(const char* hex, uint8_t* out) {
+    for (size_t i = 0; i < Token::HEX_SIZE / 2; ++i) {
+        const int high = HexValue(hex[2 * i]);
+        const int low = HexValue(hex[2 * i + 1]);
+        if (high < 0 || low < 0) {
+            return false;
+        }
+        out[i] = static_cast<uint8_t>(high << 4 | low);
+    }
+    return true;
+}
+
+#endif  // TOKEN_HAS_SSE2
+
+void StoreBigEndian(uint64_t value, uint8_t* out) {
+    for (int i = 7; i >= 0; --i) {
+        out[i] = static_cast<uint8_t>(value);
+        value >>= 8;
+    }
+}
+
+uint64_t LoadBigEndian(const uint8_t* bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < 8; ++i) {
+        value = value << 8 | bytes[i];
+    }
+    return value;
+}
+
+bool IsSpace(char c) {
+    // Класс \s регулярных выражений в локали "C"
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+}  // namespace
+
+std::optional<Token> ParseBearerToken(std::string_view header) noexcept {
+    constexpr std::string_view PREFIX = "bearer";
+    if (header.size() < PREFIX.size() + 1 + Token::HEX_SIZE) {
+        return std::nullopt;
+    }
+    for (size_t i = 0; i < PREFIX.size(); ++i) {
+        // Все символы префикса - буквы, поэтому регистр можно сбросить установкой бита 0x20
+        if ((header[i] | 0x20) != PREFIX[i]) {
+            return std::nullopt;
+        }
+    }
+
+    size_t pos = PREFIX.size();
+    while (pos < header.size() && IsSpace(header[pos])) {
+        ++pos;
+    }
+    if (pos == PREFIX.size()) {
+        return std::nullopt;
+    }
+    return Token::FromHex(header.substr(pos));
+}
+
+std::optional<Token> Token::FromHex(std::string_view hex) noexcept {
+    if (hex.size() != HEX_SIZE) {
+        return std::nullopt;
+    }
+    uint8_t bytes[HEX_SIZE / 2];
+    if (!DecodeHex(hex.data(), bytes)) {
+        return std::nullopt;
+    }
+    return Token{LoadBigEndian(bytes), LoadBigEndian(bytes + 8)};
+}
+
+void Token::ToHex(char* out) const noexcept {
+    uint8_t bytes[HEX_SIZE / 2];
+    StoreBigEndian(high_, bytes);
+    StoreBigEndian(low_, bytes + 8);
+    EncodeHex(bytes, out);
+}
+
+std::string Token::ToHex() const {
+    std::string hex(HEX_SIZE, '\0');
+    ToHex(hex.data());
+    return hex;
+}
+
+}  // namespace app
@@ -0,0 +1,56 @@
+#pragma once
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace app {
+
+// Токен авторизации игрока: 128 случайных бит. В HTTP передаётся
+// как 32 шестнадцатеричные цифры, внутри хранится в двоичном виде
+class Token {
+public:
+    constexpr static size_t HEX_SIZE = 32;
+
+    Token() = default;
+    Token(uint64_t high, uint64_t low) noexcept
+        : high_{high}
+        , low_{low} {
+    }
+
+    // Принимает ровно 32 шестнадцатеричные цифры в любом регистре
+    static std::optional<Token> FromHex(std::string_view hex) noexcept;
+
+    // Записывает в out ровно HEX_SIZE символов в нижнем регистре
+    void ToHex(char* out) const noexcept;
+    std::string ToHex() const;
+
+    uint64_t GetHigh() const noexcept {
+        return high_;
+    }
+
+    uint64_t GetLow() const noexcept {
+        return low_;
+    }
+
+    auto operator<=>(const Token&) const = default;
+
+private:
+    uint64_t high_ = 0;
+    uint64_t low_ = 0;
+};
+
+// Разбирает значение заголовка Authorization вида "Bearer <32 hex>".
+// Принимает то же, что и регулярное выражение ^Bearer\s+([0-9a-fA-F]{32})$ с icase
+std::optional<Token> ParseBearerToken(std::string_view header) noexcept;
+
+struct TokenHasher {
+    size_t operator()(const Token& token) const noexcept {
+        // Токены случайны, поэтому достаточно перемешать половины
+        return static_cast<size_t>(token.GetHigh() ^ (token.GetLow() * 0x9E3779B97F4A7C15ull));
+    }
+};
+
+}  // namespace app
@@ -0,0 +1,90 @@
+#include "websocket_session.h"
+#include "http_server.h"
+
+namespace http_server {
+
+WebSocketSession::WebSocketSession(net::any_io_executor executor)
+    : executor_(std::move(executor)) {
+}
+
+void WebSocketSession::Run(beast::tcp_stream&& stream, http::request<RequestBody, RequestFields>&& request) {
+    auto safe_request = std::make_shared<http::request<RequestBody, RequestFields>>(std::move(request));
+    net::dispatch(executor_, [self = shared_from_this(), stream = std::move(stream), safe_request]() mutable {
+        auto& ws = self->ws_.emplace(std::move(stream));
+        // Таймаут HTTP-сессии заменяем таймаутами и пингами самого WebSocket
+        beast::get_lowest_layer(ws).expires_never();
+        ws.set_option(websocket::stream_base::timeout::suggested(beast::role_type::server));
+        ws.async_accept(*safe_request, [self, safe_request](beast::error_code ec) {
+            self->OnAccept(ec);
+        });
+    });
+}
+
+void WebSocketSession::Send(Frame frame, bool binary) {
+    net::dispatch(executor_, [self = shared_from_this(), frame = std::move(frame), binary]() mutable {
+        // Неотправленный кадр устарел, его заменяет новый
+        self->pending_ = PendingFrame{std::move(frame), binary};
+        if (self->open_ && !self->writing_) {
+            self->WriteNext();
+        }
+    });
+}
+
+void WebSocketSession::OnAccept(beast::error_code ec) {
+    if (ec) {
+        closed_ = true;
+        return ReportError(ec, "websocket accept"sv);
+    }
+    open_ = true;
+    Read();
+    if (pending_) {
+        WriteNext();
+    }
+}
+
+void WebSocketSession::Read() {
+    buffer_.clear();
+    ws_->async_read(buffer_, beast::bind_front_handler(&WebSocketSession::OnRead, shared_from_this()));
+}
+
+void WebSocketSession::OnRead(beast::error_code ec, [[maybe_unused]] std::size_t bytes_read) {
+    if (ec) {
+        closed_ = true;
+        if (ec != websocket::error::closed) {
+            ReportError(ec, "websocket read"sv);
+        }
+        return;
+    }
+    Read();
+}
+
+void WebSocketSession::WriteNext() {
+    if (closed_) {
+        pending_.reset();
+        return;
+    }
+    PendingFrame next = std::move(*pending_);
+    pending_.reset();
+    writing_ = true;
+
+    ws_->binary(next.binary);
+    // Кадр захватывается, чтобы буфер жил до конца записи
+    ws_->async_write(net::buffer(*next.frame),
+                    [self = shared_from_this(), frame = next.frame](beast::error_code ec, std::size_t bytes_written) {
+                        self->OnWrite(ec, bytes_written);
+                    });
+}
+
+void WebSocketSession::OnWrite(beast::error_code ec, [[maybe_unused]] std::size_t bytes_written) {
+    writing_ = false;
+    if (ec) {
+        closed_ = true;
+        pending_.reset();
+        return ReportError(ec, "websocket write"sv);
+    }
+    if (pending_) {
+        WriteNext();
+    }
+}
+
+}  // namespace http_server
@@ -0,0 +1,74 @@
+#pragma once
+#include "message_allocator.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/beast/websocket.hpp>
+
+namespace http_server {
+
+namespace net = boost::asio;
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace websocket = beast::websocket;
+
+// WebSocket-соединение, по которому сервер рассылает клиенту кадры.
+// Входящие сообщения клиента читаются только ради управляющих кадров и отбрасываются
+class WebSocketSession : public std::enable_shared_from_this<WebSocketSession> {
+public:
+    using Frame = std::shared_ptr<const std::string>;
+
+    // Соединение создаётся раньше, чем получает поток: кадры можно отправлять сразу,
+    // они будут доставлены после рукопожатия. executor - executor будущего потока
+    explicit WebSocketSession(net::any_io_executor executor);
+
+    WebSocketSession(const WebSocketSession&) = delete;
+    WebSocketSession& operator=(const WebSocketSession&) = delete;
+
+    // Забирает поток HTTP-соединения и завершает рукопожатие по запросу на смену протокола
+    void Run(beast::tcp_stream&& stream, http::request<RequestBody, RequestFields>&& request);
+
+    // Можно вызывать из любого потока. Пока предыдущий кадр не отправлен, новые кадры
+    // замещают друг друга, поэтому медленный клиент получает лишь самый свежий кадр
+    void Send(Frame frame, bool binary = false);
+
+    bool IsClosed() const noexcept {
+        return closed_;
+    }
+
+private:
+    struct PendingFrame {
+        Frame frame;
+        bool binary;
+    };
+
+    void OnAccept(beast::error_code ec);
+    void Read();
+    void OnRead(beast::error_code ec, std::size_t bytes_read);
+    void WriteNext();
+    void OnWrite(beast::error_code ec, std::size_t bytes_written);
+
+    net::any_io_executor executor_;
+    // Поля ниже используются только в executor_
+    std::optional<websocket::stream<beast::tcp_stream>> ws_;
+    beast::flat_buffer buffer_;
+    bool open_ = false;
+    bool writing_ = false;
+    std::optional<PendingFrame> pending_;
+    std::atomic_bool closed_{false};
+};
+
+// Ответ на запрос смены протокола: вместо HTTP-ответа соединение переходит на WebSocket.
+// on_session вызывается сразу, в потоке отправителя ответа, ещё до рукопожатия.
+// Отправленные до его завершения кадры будут доставлены после него
+struct WebSocketAccept {
+    http::request<RequestBody, RequestFields> request;
+    std::function<void(std::shared_ptr<WebSocketSession>)> on_session;
+};
+
+}  // namespace http_server
@@ -0,0 +1,104 @@
+#include <catch2/catch_test_macros.hpp>
+#include <string_view>
+
+#include "../src/api_router.h"
+
+using namespace std::literals;
+using namespace http_handler;
+
+SCENARIO("API route matching") {
+    GIVEN("exact routes") {
+        const std::pair<std::string_view, Endpoint> routes[] = {
+            {"/api/v1/maps"sv, Endpoint::MAPS},
+            {"/api/v1/game/join"sv, Endpoint::JOIN},
+            {"/api/v1/game/players"sv, Endpoint::PLAYERS},
+            {"/api/v1/game/state"sv, Endpoint::STATE},
+            {"/api/v1/game/state/stream"sv, Endpoint::STATE_STREAM},
+            {"/api/v1/game/player/action"sv, Endpoint::PLAYER_ACTION},
+            {"/api/v1/game/tick"sv, Endpoint::TICK},
+        };
+        for (const auto& [target, endpoint] : routes) {
+            const auto match = MatchRoute(target);
+            REQUIRE(match);
+            CHECK(match->route->endpoint == endpoint);
+            CHECK(match->param.empty());
+        }
+    }
+
+    GIVEN("a route with parameter") {
+        THEN("the rest of the target is the parameter") {
+            const auto match = MatchRoute("/api/v1/maps/map1"sv);
+            REQUIRE(match);
+            CHECK(match->route->endpoint == Endpoint::MAP);
+            CHECK(match->param == "map1"sv);
+
+            CHECK(MatchRoute("/api/v1/maps/"sv)->param.empty());
+            CHECK(MatchRoute("/api/v1/maps/a/b"sv)->param == "a/b"sv);
+        }
+    }
+
+    GIVEN("unknown targets") {
+        CHECK_FALSE(MatchRoute(""sv));
+        CHECK_FALSE(MatchRoute("/api/v1/"sv));
+        CHECK_FALSE(MatchRoute("/api/v1/map"sv));
+        CHECK_FALSE(MatchRoute("/api/v1/maps2"sv));
+        CHECK_FALSE(MatchRoute("/api/v1/game/"sv));
+        CHECK_FALSE(MatchRoute("/api/v1/game/join/"sv));
+        CHECK_FALSE(MatchRoute("/api/v1/game/join?x=1"sv));
+        CHECK_FALSE(MatchRoute("/api/v2/maps"sv));
+        CHECK_FALSE(MatchRoute("/index.html"sv));
+    }
+
+    GIVEN("a route accepting a query string") {
+        THEN("the query is split off the path") {
+            const auto match = MatchRoute("/api/v1/game/state?since=42"sv);
+            REQUIRE(match);
+            CHECK(match->route->endpoint == Endpoint::STATE);
+            CHECK(match->query == "since=42"sv);
+
+            CHECK(MatchRoute("/api/v1/game/state?"sv)->query.empty());
+            CHECK_FALSE(MatchRoute("/api/v1/game/stat?since=42"sv));
+        }
+    }
+
+    GIVEN("a query on a route that does not accept one") {
+        THEN("a parametrized route keeps it in the parameter, so an unknown map is still not found") {
+            const auto match = MatchRoute("/api/v1/maps/map1?x=1"sv);
+            REQUIRE(match);
+            CHECK(match->route->endpoint == Endpoint::MAP);
+            CHECK(match->param == "map1?x=1"sv);
+            CHECK(match->query.empty());
+        }
+        THEN("other routes are not matched") {
+            CHECK_FALSE(MatchRoute("/api/v1/game/state/stream?x=1"sv));
+        }
+    }
+
+    GIVEN("method sets") {
+        const Route& maps = *MatchRoute("/api/v1/maps"sv)->route;
+        CHECK(maps.methods.Contains(http::verb::get));
+        CHECK(maps.methods.Contains(http::verb::head));
+        CHECK_FALSE(maps.methods.Contains(http::verb::post));
+        CHECK(maps.methods.GetAllowHeader() == "GET, HEAD"sv);
+
+        const Route& join = *MatchRoute("/api/v1/game/join"sv)->route;
+        CHECK(join.methods.Contains(http::verb::post));
+        CHECK_FALSE(join.methods.Contains(http::verb::get));
+        CHECK(join.methods.GetAllowHeader() == "POST"sv);
+        CHECK(join.invalid_method_message == "Only POST method is expected"sv);
+    }
+}
+
+SCENARIO("Query parameters") {
+    CHECK(FindQueryParam("since=42"sv, "since"sv) == "42"sv);
+    CHECK(FindQueryParam("a=1&since=42&b=2"sv, "since"sv) == "42"sv);
+    CHECK(FindQueryParam("since="sv, "since"sv) == ""sv);
+
+    CHECK_FALSE(FindQueryParam(""sv, "since"sv));
+    CHECK_FALSE(FindQueryParam("since"sv, "since"sv));
+    CHECK_FALSE(FindQueryParam("sinceX=1"sv, "since"sv));
+    CHECK_FALSE(FindQueryParam("a=since=1"sv, "since"sv));
+}
+
+// Маршрутизация полностью вычислима на этапе компиляции
+static_assert(MatchRoute("/api/v1/game/tick"sv)->route->endpoint == Endpoint::TICK);
@@ -0,0 +1,229 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/application.h"
+#include "test-maps.h"
+
+using namespace model;
+using namespace std::literals;
+using test_maps::MakeCityMap;
+
+namespace {
+
+// Игра с отдельной сессией на каждой карте, собаки в сессиях бегут в разные стороны
+struct GameFixture {
+    Game game;
+    std::vector<std::unique_ptr<Dog>> dogs;
+
+    GameFixture(size_t session_count, size_t dogs_per_session) {
+        for (size_t i = 0; i < session_count; ++i) {
+            game.AddMap(MakeCityMap(20, 10, "map"s + std::to_string(i)));
+        }
+        for (const auto& map : game.GetMaps()) {
+            GameSession* session = game.AddSession(map.GetId());
+            for (size_t i = 0; i < dogs_per_session; ++i) {
+                auto& dog = dogs.emplace_back(std::make_unique<Dog>("dog"s));
+                session->AddDog(dog.get());
+                dog->SetSpeed(i % 2 ? Vec2D{1.5, 0.0} : Vec2D{0.0, 2.5});
+            }
+        }
+    }
+
+    // Тик всех сессий по очереди в вызывающем потоке
+    void TickSequentially(std::chrono::milliseconds delta) {
+        for (GameSession* session : game.GetSessions()) {
+            session->Tick(delta);
+        }
+    }
+};
+
+// io_context, работающий в собственных потоках до своего разрушения
+class IoThreads {
+public:
+    explicit IoThreads(unsigned num_threads) {
+        for (unsigned i = 0; i < num_threads; ++i) {
+            threads_.emplace_back([this] {
+                ioc_.run();
+            });
+        }
+    }
+
+    ~IoThreads() {
+        work_.reset();
+        ioc_.stop();
+    }
+
+    net::io_context& GetContext() noexcept {
+        return ioc_;
+    }
+
+private:
+    net::io_context ioc_;
+    net::executor_work_guard<net::io_context::executor_type> work_{ioc_.get_executor()};
+    std::vector<std::jthread> threads_;
+};
+
+// Выполняет тик и ждёт его завершения во всех сессиях
+void TickAndWait(app::Application& app, std::chrono::milliseconds delta) {
+    std::promise<void> done;
+    app.Tick(delta, [&done] {
+        done.set_value();
+    });
+    done.get_future().wait();
+}
+
+}  // namespace
+
+SCENARIO("Game tick on session strands") {
+    GIVEN("two identical games with many sessions") {
+        constexpr size_t SESSION_COUNT = 16;
+        GameFixture sequential{SESSION_COUNT, 50};
+        GameFixture parallel{SESSION_COUNT, 50};
+        app::Players players;
+        IoThreads io{4};
+        app::Application app{parallel.game, players, io.GetContext()};
+
+        std::atomic<size_t> sessions_ticked{0};
+        app.SetTickListener([&sessions_ticked](GameSession&) {
+            ++sessions_ticked;
+        });
+
+        WHEN("both games are ticked") {
+            for (int i = 0; i < 10; ++i) {
+                sequential.TickSequentially(700ms);
+                TickAndWait(app, 700ms);
+                REQUIRE(sessions_ticked == SESSION_COUNT * (i + 1));
+            }
+
+            THEN("completion is reported after every session is ticked exactly like in the sequential game") {
+                REQUIRE(sequential.dogs.size() == parallel.dogs.size());
+                for (size_t i = 0; i < sequential.dogs.size(); ++i) {
+                    CHECK(sequential.dogs[i]->GetPosition().x == parallel.dogs[i]->GetPosition().x);
+                    CHECK(sequential.dogs[i]->GetPosition().y == parallel.dogs[i]->GetPosition().y);
+                    CHECK(sequential.dogs[i]->GetSpeed().u == parallel.dogs[i]->GetSpeed().u);
+                    CHECK(sequential.dogs[i]->GetSpeed().v == parallel.dogs[i]->GetSpeed().v);
+                }
+            }
+        }
+    }
+
+    GIVEN("a game without sessions") {
+        Game game;
+        app::Players players;
+        net::io_context ioc;
+        app::Application app{game, players, ioc};
+
+        THEN("completion is reported at once") {
+            bool done = false;
+            app.Tick(1s, [&done] {
+                done = true;
+            });
+            CHECK(done);
+        }
+    }
+}
+
+SCENARIO("Session strands on several io_contexts") {
+    GIVEN("an application with an io_context per thread") {
+        constexpr size_t SESSION_COUNT = 6;
+        GameFixture fixture{SESSION_COUNT, 10};
+        app::Players players;
+        std::vector<std::unique_ptr<net::io_context>> contexts;
+        for (int i = 0; i < 3; ++i) {
+            contexts.push_back(std::make_unique<net::io_context>(1));
+        }
+        app::Application app{fixture.game, players, contexts};
+
+        THEN("sessions are spread over the contexts in turn") {
+            const auto sessions = fixture.game.GetSessions();
+            for (size_t i = 0; i < sessions.size(); ++i) {
+                CHECK(&app.GetSessionStrand(*sessions[i]).context() == contexts[i % contexts.size()].get());
+            }
+        }
+
+        WHEN("the game is ticked while each context runs in its own thread") {
+            std::promise<void> done;
+            app.Tick(100ms, [&done] {
+                done.set_value();
+            });
+            {
+                std::vector<std::jthread> threads;
+                for (auto& context : contexts) {
+                    threads.emplace_back([&context] {
+                        context->run();
+                    });
+                }
+            }
+
+            THEN("every session is ticked") {
+                CHECK(done.get_future().wait_for(0s) == std::future_status::ready);
+                for (const auto& dog : fixture.dogs) {
+                    CHECK(dog->GetPosition().x + dog->GetPosition().y > 0.0);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("Ticker backpressure") {
+    GIVEN("a ticker whose handler takes longer than its period") {
+        net::io_context ioc;
+        auto strand = net::make_strand(ioc);
+        net::steady_timer work_timer{strand};
+        bool in_progress = false;
+        int overlaps = 0;
+        int ticks = 0;
+        std::shared_ptr<app::Ticker> ticker;
+        ticker = std::make_shared<app::Ticker>(strand, 1ms, [&](std::chrono::milliseconds, app::Ticker::Done done) {
+            overlaps += in_progress;
+            in_progress = true;
+            // Срабатывание завершается асинхронно, через несколько периодов
+            work_timer.expires_after(5ms);
+            work_timer.async_wait([&, done = std::move(done)](boost::system::error_code) {
+                in_progress = false;
+                if (++ticks == 5) {
+                    ticker->Stop();
+                }
+                done();
+            });
+        });
+
+        WHEN("it runs") {
+            ticker->Start();
+            ioc.run_for(2s);
+
+            THEN("the next tick waits until the previous one is done") {
+                CHECK(ticks == 5);
+                CHECK(overlaps == 0);
+            }
+        }
+    }
+}
+
+TEST_CASE("Game tick latency", "[!benchmark]") {
+    const unsigned concurrency = std::max(2u, std::thread::hardware_concurrency());
+    IoThreads io{concurrency};
+
+    for (size_t session_count : {1, 4, 16, 64}) {
+        GameFixture sequential{session_count, 1'000};
+        GameFixture parallel{session_count, 1'000};
+        app::Players players;
+        app::Application app{parallel.game, players, io.GetContext()};
+
+        BENCHMARK("sequential tick, sessions: " + std::to_string(session_count)) {
+            sequential.TickSequentially(10ms);
+        };
+        // Время от запроса тика до сообщения о его завершении в последней сессии
+        BENCHMARK("tick on session strands, sessions: " + std::to_string(session_count)) {
+            TickAndWait(app, 10ms);
+        };
+    }
+}
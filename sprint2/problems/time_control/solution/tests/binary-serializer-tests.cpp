@@ -0,0 +1,180 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../src/binary_serializer.h"
+#include "../src/json_serializer.h"
+
+using namespace std::literals;
+
+namespace {
+
+using Dogs = std::vector<std::unique_ptr<model::Dog>>;
+
+struct DecodedDog {
+    uint64_t id;
+    double x, y, u, v;
+    std::string dir;
+};
+
+class Decoder {
+public:
+    explicit Decoder(std::string_view data)
+        : data_{data} {
+    }
+
+    uint64_t ReadVarint() {
+        uint64_t value = 0;
+        for (int shift = 0;; shift += 7) {
+            const auto byte = static_cast<unsigned char>(data_.at(pos_++));
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+    }
+
+    int64_t ReadSigned() {
+        const uint64_t value = ReadVarint();
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    double ReadFixed() {
+        return static_cast<double>(ReadSigned()) / binary_serializer::POSITION_SCALE;
+    }
+
+    char ReadByte() {
+        return data_.at(pos_++);
+    }
+
+    bool AtEnd() const {
+        return pos_ == data_.size();
+    }
+
+private:
+    std::string_view data_;
+    size_t pos_ = 0;
+};
+
+std::vector<DecodedDog> Decode(std::string_view data) {
+    Decoder decoder{data};
+    REQUIRE(decoder.ReadByte() == 1);
+    std::vector<DecodedDog> dogs(decoder.ReadVarint());
+    uint64_t id = 0;
+    for (auto& dog : dogs) {
+        id += decoder.ReadSigned();
+        dog.id = id;
+        dog.x = decoder.ReadFixed();
+        dog.y = decoder.ReadFixed();
+        dog.u = decoder.ReadFixed();
+        dog.v = decoder.ReadFixed();
+        dog.dir = std::string(1, "LRUD"[decoder.ReadByte()]);
+    }
+    CHECK(decoder.AtEnd());
+    return dogs;
+}
+
+// Собаки в духе настоящей сессии: id растут в порядке входа, большинство стоит на месте
+std::vector<model::Dog*> MakeDogs(Dogs& storage, size_t count, std::mt19937_64& generator) {
+    std::uniform_real_distribution<double> coord{0.0, 100.0};
+    const std::string directions[] = {"L"s, "R"s, "U"s, "D"s};
+    std::vector<model::Dog*> dogs;
+    for (size_t i = 0; i < count; ++i) {
+        auto& dog = storage.emplace_back(std::make_unique<model::Dog>("dog"s));
+        dog->SetId(model::Dog::Id{i * 3 + generator() % 3});
+        dog->SetPosition({coord(generator), coord(generator)});
+        dog->SetSpeed(generator() % 4 ? model::Vec2D{} : model::Vec2D{-1.5, 0.0});
+        dog->SetDirection(directions[generator() % 4]);
+        dogs.push_back(dog.get());
+    }
+    return dogs;
+}
+
+}  // namespace
+
+SCENARIO("Binary game state") {
+    std::mt19937_64 generator{11};
+    Dogs storage;
+
+    GIVEN("no dogs") {
+        std::string out;
+        binary_serializer::AppendGameState(out, {});
+        CHECK(out == "\x01\x00"s);
+    }
+
+    GIVEN("a session with dogs") {
+        const auto dogs = MakeDogs(storage, 1000, generator);
+        std::string out;
+        binary_serializer::AppendGameState(out, dogs);
+
+        THEN("it decodes back within the fixed point step") {
+            const auto decoded = Decode(out);
+            REQUIRE(decoded.size() == dogs.size());
+            const double tolerance = 0.5 / binary_serializer::POSITION_SCALE;
+            for (size_t i = 0; i < dogs.size(); ++i) {
+                CHECK(decoded[i].id == *dogs[i]->GetId());
+                CHECK(std::abs(decoded[i].x - dogs[i]->GetPosition().x) <= tolerance);
+                CHECK(std::abs(decoded[i].y - dogs[i]->GetPosition().y) <= tolerance);
+                CHECK(std::abs(decoded[i].u - dogs[i]->GetSpeed().u) <= tolerance);
+                CHECK(std::abs(decoded[i].v - dogs[i]->GetSpeed().v) <= tolerance);
+                CHECK(decoded[i].dir == dogs[i]->GetDirection());
+            }
+        }
+
+        THEN("it is several times smaller than JSON") {
+            std::string json;
+            json_serializer::AppendGameState(json, dogs);
+            CHECK(out.size() * 5 < json.size());
+        }
+    }
+
+    GIVEN("negative coordinates and ids out of order") {
+        model::Dog first{"a"s};
+        first.SetId(model::Dog::Id{10});
+        first.SetPosition({-0.4, -12.3456});
+        model::Dog second{"b"s};
+        second.SetId(model::Dog::Id{2});
+        second.SetSpeed({0.0, -3.0});
+        second.SetDirection("D"s);
+
+        std::string out;
+        binary_serializer::AppendGameState(out, {&first, &second});
+        const auto decoded = Decode(out);
+        REQUIRE(decoded.size() == 2);
+        CHECK(decoded[0].id == 10);
+        CHECK(decoded[0].x == -0.4);
+        CHECK(decoded[0].y == -12.346);
+        CHECK(decoded[1].id == 2);
+        CHECK(decoded[1].v == -3.0);
+        CHECK(decoded[1].dir == "D"s);
+    }
+}
+
+TEST_CASE("Binary state benchmark", "[!benchmark]") {
+    std::mt19937_64 generator{11};
+    Dogs storage;
+    const auto dogs = MakeDogs(storage, 10000, generator);
+
+    std::string json;
+    json_serializer::AppendGameState(json, dogs);
+    std::string binary;
+    binary_serializer::AppendGameState(binary, dogs);
+    INFO("10k dogs: JSON " << json.size() << " bytes, binary " << binary.size() << " bytes");
+    CHECK(binary.size() < json.size());
+
+    BENCHMARK("JSON state, 10k dogs") {
+        std::string out;
+        json_serializer::AppendGameState(out, dogs);
+        return out;
+    };
+    BENCHMARK("binary state, 10k dogs") {
+        std::string out;
+        binary_serializer::AppendGameState(out, dogs);
+        return out;
+    };
+}
@@ -0,0 +1,158 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "../src/concurrent_index.h"
+
+using namespace std::literals;
+
+namespace {
+
+using Index = util::ConcurrentIndex<std::string, int>;
+
+std::string MakeKey(int i) {
+    return "key-"s + std::to_string(i);
+}
+
+// Индекс на основе unordered_map под shared_mutex для сравнения
+class LockedIndex {
+public:
+    bool Insert(std::string key, int value) {
+        std::unique_lock lock{mutex_};
+        return map_.emplace(std::move(key), value).second;
+    }
+
+    const int* Find(const std::string& key) const {
+        std::shared_lock lock{mutex_};
+        auto it = map_.find(key);
+        return it != map_.end() ? &it->second : nullptr;
+    }
+
+private:
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<std::string, int> map_;
+};
+
+// Каждый поток выполняет operations обращений, из которых 1% - добавления новых ключей
+template <typename IndexType>
+size_t RunReadMostly(IndexType& index, int preloaded, unsigned thread_count, int operations) {
+    std::atomic<int> next_key = preloaded;
+    std::atomic<size_t> found = 0;
+    {
+        std::vector<std::jthread> threads;
+        for (unsigned t = 0; t < thread_count; ++t) {
+            threads.emplace_back([&, t] {
+                size_t local_found = 0;
+                for (int i = 0; i < operations; ++i) {
+                    if (i % 100 == 0) {
+                        const int key = next_key++;
+                        index.Insert(MakeKey(key), key);
+                    } else if (index.Find(MakeKey((i * 7919 + static_cast<int>(t)) % preloaded))) {
+                        ++local_found;
+                    }
+                }
+                found += local_found;
+            });
+        }
+    }
+    return found;
+}
+
+}  // namespace
+
+SCENARIO("Concurrent index") {
+    GIVEN("an empty index") {
+        Index index{4};
+
+        THEN("nothing can be found") {
+            CHECK(index.Find("key"s) == nullptr);
+            CHECK(index.Size() == 0);
+        }
+
+        WHEN("many keys are inserted") {
+            for (int i = 0; i < 10'000; ++i) {
+                REQUIRE(index.Insert(MakeKey(i), i));
+            }
+
+            THEN("all of them can be found") {
+                CHECK(index.Size() == 10'000);
+                for (int i = 0; i < 10'000; ++i) {
+                    const int* value = index.Find(MakeKey(i));
+                    REQUIRE(value != nullptr);
+                    CHECK(*value == i);
+                }
+                CHECK(index.Find(MakeKey(10'000)) == nullptr);
+            }
+
+            THEN("duplicate keys are rejected") {
+                CHECK_FALSE(index.Insert(MakeKey(42), -1));
+                CHECK(*index.Find(MakeKey(42)) == 42);
+            }
+        }
+    }
+
+    GIVEN("readers running while keys are inserted") {
+        Index index{4};
+        constexpr int KEY_COUNT = 20'000;
+        std::atomic<int> inserted = 0;
+        std::atomic<size_t> misses = 0;
+
+        {
+            std::vector<std::jthread> readers;
+            for (int t = 0; t < 4; ++t) {
+                readers.emplace_back([&] {
+                    while (inserted < KEY_COUNT) {
+                        // Всё, что добавлено до начала поиска, должно находиться
+                        const int known = inserted;
+                        for (int i = std::max(0, known - 100); i < known; ++i) {
+                            const int* value = index.Find(MakeKey(i));
+                            if (!value || *value != i) {
+                                ++misses;
+                            }
+                        }
+                    }
+                });
+            }
+            for (int i = 0; i < KEY_COUNT; ++i) {
+                index.Insert(MakeKey(i), i);
+                ++inserted;
+            }
+        }
+
+        THEN("readers always see completed insertions") {
+            CHECK(misses == 0);
+        }
+    }
+}
+
+TEST_CASE("Concurrent index read-mostly benchmark", "[!benchmark]") {
+    constexpr int PRELOADED = 100'000;
+    constexpr int OPERATIONS = 100'000;
+    const unsigned thread_count = std::max(2u, std::thread::hardware_concurrency());
+
+    BENCHMARK_ADVANCED("shared_mutex + unordered_map")(Catch::Benchmark::Chronometer meter) {
+        LockedIndex index;
+        for (int i = 0; i < PRELOADED; ++i) {
+            index.Insert(MakeKey(i), i);
+        }
+        meter.measure([&] {
+            return RunReadMostly(index, PRELOADED, thread_count, OPERATIONS);
+        });
+    };
+
+    BENCHMARK_ADVANCED("ConcurrentIndex")(Catch::Benchmark::Chronometer meter) {
+        Index index;
+        for (int i = 0; i < PRELOADED; ++i) {
+            index.Insert(MakeKey(i), i);
+        }
+        meter.measure([&] {
+            return RunReadMostly(index, PRELOADED, thread_count, OPERATIONS);
+        });
+    };
+}
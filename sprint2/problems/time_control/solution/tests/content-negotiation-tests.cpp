@@ -0,0 +1,77 @@
+#include <catch2/catch_test_macros.hpp>
+#include <string_view>
+
+#include "../src/content_negotiation.h"
+
+using namespace std::literals;
+using namespace http_handler;
+
+SCENARIO("Quality values") {
+    WHEN("the weight is well-formed") {
+        THEN("it is used as is") {
+            CHECK(detail::GetQuality("q=0"sv) == 0.0);
+            CHECK(detail::GetQuality("q=0.000"sv) == 0.0);
+            CHECK(detail::GetQuality("q=0.3"sv) == 0.3);
+            CHECK(detail::GetQuality(" Q=0.25"sv) == 0.25);
+            CHECK(detail::GetQuality("q=1."sv) == 1.0);
+            CHECK(detail::GetQuality("level=1; q=0.5"sv) == 0.5);
+            CHECK(detail::GetQuality("q=0.0001"sv) > 0.0);
+        }
+    }
+    WHEN("the weight is above 1") {
+        THEN("it is clamped") {
+            CHECK(detail::GetQuality("q=1.5"sv) == 1.0);
+            CHECK(detail::GetQuality("q=20"sv) == 1.0);
+        }
+    }
+    WHEN("the weight is missing or malformed") {
+        THEN("the element keeps the default weight") {
+            CHECK(detail::GetQuality(""sv) == 1.0);
+            CHECK(detail::GetQuality("level=1"sv) == 1.0);
+            CHECK(detail::GetQuality("q="sv) == 1.0);
+            CHECK(detail::GetQuality("q=abc"sv) == 1.0);
+            CHECK(detail::GetQuality("q=.5"sv) == 1.0);
+            CHECK(detail::GetQuality("q=-1"sv) == 1.0);
+            CHECK(detail::GetQuality("q=0.5x"sv) == 1.0);
+        }
+    }
+}
+
+SCENARIO("Accept header negotiation") {
+    constexpr auto type = "application/x-dog-state"sv;
+
+    CHECK(AcceptsMediaType("application/x-dog-state"sv, type));
+    CHECK(AcceptsMediaType("Application/X-Dog-State"sv, type));
+    CHECK(AcceptsMediaType("application/json, application/x-dog-state;q=0.9"sv, type));
+    CHECK(AcceptsMediaType("text/html,\tapplication/x-dog-state ; q=0.5"sv, type));
+    CHECK(AcceptsMediaType("application/x-dog-state;q=0.001"sv, type));
+
+    CHECK_FALSE(AcceptsMediaType(""sv, type));
+    CHECK_FALSE(AcceptsMediaType("*/*"sv, type));
+    CHECK_FALSE(AcceptsMediaType("application/*"sv, type));
+    CHECK_FALSE(AcceptsMediaType("application/json"sv, type));
+    CHECK_FALSE(AcceptsMediaType("application/x-dog-states"sv, type));
+    CHECK_FALSE(AcceptsMediaType("application/x-dog-state;q=0"sv, type));
+    CHECK_FALSE(AcceptsMediaType("application/x-dog-state; q=0.000"sv, type));
+    CHECK_FALSE(AcceptsMediaType("application/x-dog-state;level=1;q=0"sv, type));
+}
+
+SCENARIO("Accept-Encoding weights") {
+    CHECK(GetEncodingQuality("gzip, deflate, br"sv, "br"sv) == 1.0);
+    CHECK(GetEncodingQuality("GZIP;q=0.5"sv, "gzip"sv) == 0.5);
+    CHECK(GetEncodingQuality("br;q=0, gzip"sv, "br"sv) == 0.0);
+    CHECK(GetEncodingQuality("gzip"sv, "br"sv) == 0.0);
+    CHECK(GetEncodingQuality("gzip ; q=0.8, *;q=0.1"sv, "br"sv) == 0.1);
+    CHECK(GetEncodingQuality("br;q=2"sv, "br"sv) == 1.0);
+    CHECK(GetEncodingQuality("br;q=x"sv, "br"sv) == 1.0);
+
+    THEN("identity is acceptable unless excluded") {
+        CHECK(GetEncodingQuality(""sv, "identity"sv) == 1.0);
+        CHECK(GetEncodingQuality("gzip"sv, "identity"sv) == 1.0);
+        CHECK(GetEncodingQuality("gzip, *;q=0"sv, "identity"sv) == 0.0);
+        CHECK(GetEncodingQuality("identity;q=0.3"sv, "identity"sv) == 0.3);
+    }
+}
+
+// Разбор весов вычислим на этапе компиляции
+static_assert(GetEncodingQuality("gzip;q=0.5"sv, "gzip"sv) == 0.5);
@@ -0,0 +1,111 @@
+#include <catch2/catch_test_macros.hpp>
+#include <string>
+
+#include "../src/http_cache.h"
+
+using namespace std::literals;
+using namespace http_handler;
+
+SCENARIO("Strong ETag") {
+    const std::string etag = MakeStrongETag("{\"id\":\"map1\"}"sv);
+
+    THEN("it is a quoted opaque tag") {
+        REQUIRE(etag.size() == 18);
+        CHECK(etag.front() == '"');
+        CHECK(etag.back() == '"');
+        CHECK(etag.find_first_not_of("0123456789abcdef", 1) == 17);
+    }
+    THEN("it depends only on the content") {
+        CHECK(MakeStrongETag("{\"id\":\"map1\"}"sv) == etag);
+        CHECK(MakeStrongETag("{\"id\":\"map2\"}"sv) != etag);
+    }
+}
+
+SCENARIO("If-None-Match matching") {
+    const auto etag = "\"0123456789abcdef\""sv;
+
+    CHECK(IfNoneMatchHits(etag, etag));
+    CHECK(IfNoneMatchHits("*"sv, etag));
+    CHECK(IfNoneMatchHits(" * "sv, etag));
+    CHECK(IfNoneMatchHits("W/\"0123456789abcdef\""sv, etag));
+    CHECK(IfNoneMatchHits("\"other\", \"0123456789abcdef\""sv, etag));
+    CHECK(IfNoneMatchHits("\"other\",\t\"0123456789abcdef\" "sv, etag));
+
+    CHECK_FALSE(IfNoneMatchHits(""sv, etag));
+    CHECK_FALSE(IfNoneMatchHits("\"other\""sv, etag));
+    CHECK_FALSE(IfNoneMatchHits("0123456789abcdef"sv, etag));
+    CHECK_FALSE(IfNoneMatchHits("\"0123456789abcdef\"x"sv, etag));
+    CHECK_FALSE(IfNoneMatchHits("\"other\", *"sv, etag));
+}
+
+SCENARIO("HTTP dates") {
+    using namespace std::chrono;
+    const sys_seconds time = sys_days{1994y / November / 6} + 8h + 49min + 37s;
+
+    THEN("they are formatted as IMF-fixdate") {
+        CHECK(FormatHttpDate(time) == "Sun, 06 Nov 1994 08:49:37 GMT");
+        CHECK(FormatHttpDate(sys_seconds{}) == "Thu, 01 Jan 1970 00:00:00 GMT");
+    }
+    THEN("IMF-fixdate is parsed back") {
+        CHECK(ParseHttpDate("Sun, 06 Nov 1994 08:49:37 GMT") == time);
+        CHECK(ParseHttpDate("Tue, 29 Feb 2028 23:59:59 GMT") == sys_days{2028y / February / 29} + 23h + 59min + 59s);
+    }
+    THEN("other formats and invalid dates are rejected") {
+        CHECK_FALSE(ParseHttpDate("Sunday, 06-Nov-94 08:49:37 GMT"));
+        CHECK_FALSE(ParseHttpDate("Sun Nov  6 08:49:37 1994"));
+        CHECK_FALSE(ParseHttpDate("Sun, 06 Nov 1994 08:49:37 UTC"));
+        CHECK_FALSE(ParseHttpDate("Sun, 06 Xyz 1994 08:49:37 GMT"));
+        CHECK_FALSE(ParseHttpDate("Sun, 31 Nov 1994 08:49:37 GMT"));
+        CHECK_FALSE(ParseHttpDate("Sun, 06 Nov 1994 24:00:00 GMT"));
+        CHECK_FALSE(ParseHttpDate("Sun, 0a Nov 1994 08:49:37 GMT"));
+        CHECK_FALSE(ParseHttpDate(""));
+    }
+}
+
+SCENARIO("Conditional requests") {
+    using namespace std::chrono;
+    const auto etag = "\"0123456789abcdef\""sv;
+    const sys_seconds modified = sys_days{2024y / March / 1} + 12h;
+
+    THEN("If-None-Match takes precedence over If-Modified-Since") {
+        CHECK(IsNotModified(etag, std::nullopt, etag, modified));
+        CHECK(IsNotModified(etag, "Thu, 01 Jan 1970 00:00:00 GMT"sv, etag, modified));
+        CHECK_FALSE(IsNotModified("\"other\""sv, "Fri, 01 Mar 2024 12:00:00 GMT"sv, etag, modified));
+    }
+    THEN("weak ETags match weakly") {
+        CHECK(IsNotModified("W/\"100-5\""sv, std::nullopt, "W/\"100-5\""sv, modified));
+        CHECK(IsNotModified("\"100-5\""sv, std::nullopt, "W/\"100-5\""sv, modified));
+    }
+    THEN("If-Modified-Since compares with second precision") {
+        CHECK(IsNotModified(std::nullopt, "Fri, 01 Mar 2024 12:00:00 GMT"sv, etag, modified));
+        CHECK(IsNotModified(std::nullopt, "Sat, 02 Mar 2024 00:00:00 GMT"sv, etag, modified));
+        CHECK_FALSE(IsNotModified(std::nullopt, "Fri, 01 Mar 2024 11:59:59 GMT"sv, etag, modified));
+        CHECK_FALSE(IsNotModified(std::nullopt, "yesterday"sv, etag, modified));
+        CHECK_FALSE(IsNotModified(std::nullopt, std::nullopt, etag, modified));
+    }
+}
+
+SCENARIO("Shared string body") {
+    auto content = std::make_shared<const std::string>("{\"maps\":[]}");
+    SharedStringResponse res{http::status::ok, 11};
+    res.body() = content;
+
+    THEN("the writer exposes the shared buffer without copying") {
+        SharedStringBody::writer writer{res.base(), res.body()};
+        beast::error_code ec;
+        writer.init(ec);
+        auto chunk = writer.get(ec);
+        REQUIRE(chunk.has_value());
+        CHECK_FALSE(chunk->second);
+        CHECK(chunk->first.data() == content->data());
+        CHECK(chunk->first.size() == content->size());
+        CHECK(SharedStringBody::size(res.body()) == content->size());
+    }
+    THEN("an empty body produces no buffers") {
+        res.body() = nullptr;
+        SharedStringBody::writer writer{res.base(), res.body()};
+        beast::error_code ec;
+        writer.init(ec);
+        CHECK_FALSE(writer.get(ec).has_value());
+    }
+}
@@ -0,0 +1,136 @@
+#include <catch2/catch_test_macros.hpp>
+#include <boost/beast/http/write.hpp>
+#include <sstream>
+#include <string>
+
+#include "../src/http_range.h"
+
+using namespace std::literals;
+using namespace http_handler;
+
+namespace {
+
+using Ranges = std::vector<ByteRange>;
+
+// Тело ответа в том виде, в каком его отправит сериализатор Beast
+std::string SerializeBody(ByteRangesResponse& res) {
+    res.prepare_payload();
+    std::ostringstream out;
+    out << res;
+    const std::string message = out.str();
+    return message.substr(message.find("\r\n\r\n") + 4);
+}
+
+}  // namespace
+
+SCENARIO("Range header parsing") {
+    constexpr uint64_t SIZE = 1000;
+
+    WHEN("a single range is requested") {
+        THEN("bounds are inclusive and clamped to the representation") {
+            CHECK(ParseRange("bytes=0-0", SIZE) == Ranges{{0, 0}});
+            CHECK(ParseRange("bytes=0-999", SIZE) == Ranges{{0, 999}});
+            CHECK(ParseRange("bytes=500-", SIZE) == Ranges{{500, 999}});
+            CHECK(ParseRange("bytes=999-999", SIZE) == Ranges{{999, 999}});
+            CHECK(ParseRange("bytes=990-5000", SIZE) == Ranges{{990, 999}});
+            CHECK(ParseRange("bytes=0-99999999999999999999999", SIZE) == Ranges{{0, 999}});
+            CHECK(ParseRange("Bytes=1-2", SIZE) == Ranges{{1, 2}});
+        }
+        THEN("a suffix selects the last bytes") {
+            CHECK(ParseRange("bytes=-1", SIZE) == Ranges{{999, 999}});
+            CHECK(ParseRange("bytes=-1000", SIZE) == Ranges{{0, 999}});
+            CHECK(ParseRange("bytes=-5000", SIZE) == Ranges{{0, 999}});
+        }
+        THEN("ranges outside the representation are unsatisfiable") {
+            CHECK(ParseRange("bytes=1000-", SIZE) == Ranges{});
+            CHECK(ParseRange("bytes=1000-1000", SIZE) == Ranges{});
+            CHECK(ParseRange("bytes=99999999999999999999999-", SIZE) == Ranges{});
+            CHECK(ParseRange("bytes=-0", SIZE) == Ranges{});
+            CHECK(ParseRange("bytes=0-", 0) == Ranges{});
+            CHECK(ParseRange("bytes=-1", 0) == Ranges{});
+        }
+    }
+
+    WHEN("several ranges are requested") {
+        THEN("they keep the requested order and unsatisfiable ones are dropped") {
+            CHECK(ParseRange("bytes=0-1,5-6", SIZE) == Ranges{{0, 1}, {5, 6}});
+            CHECK(ParseRange("bytes= 900-, -10 ,\t0-0", SIZE) == Ranges{{900, 999}, {990, 999}, {0, 0}});
+            CHECK(ParseRange("bytes=0-1,2000-3000", SIZE) == Ranges{{0, 1}});
+            CHECK(ParseRange("bytes=0-1,,5-6,", SIZE) == Ranges{{0, 1}, {5, 6}});
+            CHECK(ParseRange("bytes=2000-,3000-", SIZE) == Ranges{});
+        }
+        THEN("too many ranges make the header ignored") {
+            std::string range = "bytes=0-0";
+            for (size_t i = 1; i < MAX_BYTE_RANGES; ++i) {
+                range += "," + std::to_string(i) + "-" + std::to_string(i);
+            }
+            CHECK(ParseRange(range, SIZE)->size() == MAX_BYTE_RANGES);
+            CHECK_FALSE(ParseRange(range + ",100-100", SIZE));
+        }
+    }
+
+    WHEN("the header is malformed") {
+        THEN("it is ignored") {
+            CHECK_FALSE(ParseRange("", SIZE));
+            CHECK_FALSE(ParseRange("bytes=", SIZE));
+            CHECK_FALSE(ParseRange("bytes=,", SIZE));
+            CHECK_FALSE(ParseRange("items=0-1", SIZE));
+            CHECK_FALSE(ParseRange("bytes 0-1", SIZE));
+            CHECK_FALSE(ParseRange("bytes=5-3", SIZE));
+            CHECK_FALSE(ParseRange("bytes=-", SIZE));
+            CHECK_FALSE(ParseRange("bytes=1", SIZE));
+            CHECK_FALSE(ParseRange("bytes=a-b", SIZE));
+            CHECK_FALSE(ParseRange("bytes=1 - 2", SIZE));
+            CHECK_FALSE(ParseRange("bytes=-1-2", SIZE));
+            CHECK_FALSE(ParseRange("bytes=0-1,x", SIZE));
+        }
+    }
+}
+
+SCENARIO("If-Range matching") {
+    using namespace std::chrono;
+    const sys_seconds modified = sys_days{2024y / March / 1} + 12h;
+
+    CHECK(IfRangeMatches("\"0123456789abcdef\"", "\"0123456789abcdef\"", modified));
+    CHECK(IfRangeMatches(" Fri, 01 Mar 2024 12:00:00 GMT", "\"0123456789abcdef\"", modified));
+
+    CHECK_FALSE(IfRangeMatches("\"other\"", "\"0123456789abcdef\"", modified));
+    CHECK_FALSE(IfRangeMatches("W/\"0123456789abcdef\"", "\"0123456789abcdef\"", modified));
+    CHECK_FALSE(IfRangeMatches("W/\"100-5\"", "W/\"100-5\"", modified));
+    CHECK_FALSE(IfRangeMatches("Sat, 02 Mar 2024 00:00:00 GMT", "\"0123456789abcdef\"", modified));
+    CHECK_FALSE(IfRangeMatches("", "\"0123456789abcdef\"", modified));
+}
+
+SCENARIO("Byte ranges body") {
+    auto content = std::make_shared<const std::string>("0123456789");
+    ByteRangesResponse res{http::status::partial_content, 11};
+
+    WHEN("it holds a single range") {
+        res.body() = {content, {{2, 4}}, {}};
+
+        THEN("only that slice is sent") {
+            CHECK(SerializeBody(res) == "234");
+            CHECK(res[http::field::content_length] == "3");
+            CHECK(MakeContentRange({2, 4}, content->size()) == "bytes 2-4/10");
+        }
+    }
+
+    WHEN("it holds several ranges") {
+        res.body() = MakeMultipartRanges(content, {{0, 0}, {8, 9}}, "text/plain", "BOUNDARY");
+
+        THEN("the parts are framed as multipart/byteranges") {
+            const std::string body = SerializeBody(res);
+            CHECK(body
+                  == "--BOUNDARY\r\nContent-Type: text/plain\r\nContent-Range: bytes 0-0/10\r\n\r\n0"
+                     "\r\n--BOUNDARY\r\nContent-Type: text/plain\r\nContent-Range: bytes 8-9/10\r\n\r\n89"
+                     "\r\n--BOUNDARY--\r\n");
+            CHECK(res[http::field::content_length] == std::to_string(body.size()));
+        }
+    }
+
+    WHEN("it has no source") {
+        THEN("nothing is sent") {
+            CHECK(SerializeBody(res).empty());
+        }
+    }
+}
@@ -0,0 +1,223 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/http_server.h"
+
+using namespace std::literals;
+using namespace http_server;
+
+namespace {
+
+// Отвечает телом "<цель>". На /slow отвечает с задержкой, из обработчика таймера.
+// На /not-modified и HEAD отвечает без тела
+struct EchoHandler {
+    net::io_context& ioc;
+
+    template <typename Request, typename Send, typename Endpoint>
+    void operator()(Request&& req, Send&& send, const Endpoint&) {
+        if (req.target() == "/not-modified" || req.method() == http::verb::head) {
+            using EmptyResponse = http::response<http::empty_body, ResponseFields>;
+            EmptyResponse res{req.method() == http::verb::head ? http::status::ok : http::status::not_modified, req.version()};
+            res.set(http::field::etag, "\"tag\"");
+            res.content_length(req.target().size());
+            res.keep_alive(req.keep_alive());
+            return send(std::move(res));
+        }
+
+        StringResponse res{http::status::ok, req.version()};
+        res.body() = std::string(req.target());
+        res.keep_alive(req.keep_alive());
+        res.prepare_payload();
+
+        if (req.target() == "/slow") {
+            auto timer = std::make_shared<net::steady_timer>(ioc, 100ms);
+            timer->async_wait([timer, res = std::move(res), send = std::forward<Send>(send)](sys::error_code) mutable {
+                send(std::move(res));
+            });
+        } else {
+            send(std::move(res));
+        }
+    }
+};
+
+// Сервер из Listener'ов, работающий в собственных потоках до своего разрушения
+class TestServer {
+public:
+    TestServer(ListenMode mode, unsigned num_threads) {
+        using MyListener = Listener<EchoHandler>;
+        const unsigned num_contexts = mode == ListenMode::PER_THREAD ? num_threads : 1;
+        for (unsigned i = 0; i < num_contexts; ++i) {
+            contexts_.push_back(std::make_unique<net::io_context>());
+        }
+        // Первый сокет выбирает свободный порт, остальные слушают тот же порт
+        tcp::endpoint endpoint{net::ip::make_address("127.0.0.1"), 0};
+        for (auto& ioc : contexts_) {
+            auto listener = std::make_shared<MyListener>(*ioc, endpoint, EchoHandler{*ioc}, mode);
+            endpoint = listener->GetLocalEndpoint();
+            listener->Run();
+        }
+        endpoint_ = endpoint;
+        for (unsigned i = 0; i < num_threads; ++i) {
+            threads_.emplace_back([&ioc = *contexts_[i % num_contexts]] {
+                ioc.run();
+            });
+        }
+    }
+
+    ~TestServer() {
+        for (auto& ioc : contexts_) {
+            ioc->stop();
+        }
+        threads_.clear();
+    }
+
+    const tcp::endpoint& GetEndpoint() const noexcept {
+        return endpoint_;
+    }
+
+private:
+    std::vector<std::unique_ptr<net::io_context>> contexts_;
+    std::vector<std::jthread> threads_;
+    tcp::endpoint endpoint_;
+};
+
+// Открывает соединение, выполняет на нём один запрос и возвращает тело ответа
+std::string FetchOnce(net::io_context& client_ioc, const tcp::endpoint& endpoint, beast::string_view target) {
+    tcp::socket client{client_ioc};
+    client.connect(endpoint);
+    StringRequest req{http::verb::get, target, 11};
+    req.set(http::field::host, "x");
+    req.keep_alive(false);
+    http::write(client, req);
+    beast::flat_buffer buffer;
+    http::response<http::string_body> res;
+    http::read(client, buffer, res);
+    return res.body();
+}
+
+// Выполняет num_clients * connections_per_client соединений из num_clients потоков
+size_t FetchConcurrently(const tcp::endpoint& endpoint, unsigned num_clients, unsigned connections_per_client) {
+    std::atomic<size_t> succeeded{0};
+    {
+        std::vector<std::jthread> clients;
+        for (unsigned i = 0; i < num_clients; ++i) {
+            clients.emplace_back([&] {
+                net::io_context client_ioc;
+                for (unsigned j = 0; j < connections_per_client; ++j) {
+                    if (FetchOnce(client_ioc, endpoint, "/c") == "/c") {
+                        ++succeeded;
+                    }
+                }
+            });
+        }
+    }
+    return succeeded;
+}
+
+}  // namespace
+
+SCENARIO("Per-thread listeners") {
+    GIVEN("a server with a SO_REUSEPORT socket on each of several threads") {
+        TestServer server{ListenMode::PER_THREAD, 4};
+
+        THEN("connections from several clients are all served") {
+            CHECK(FetchConcurrently(server.GetEndpoint(), 4, 25) == 100);
+        }
+    }
+}
+
+TEST_CASE("Accepted connections per second", "[!benchmark]") {
+    constexpr unsigned num_threads = 4;
+    constexpr unsigned num_clients = 8;
+    constexpr unsigned connections_per_client = 8;
+
+    // Каждая итерация открывает num_clients * connections_per_client соединений
+    {
+        TestServer server{ListenMode::SHARED, num_threads};
+        BENCHMARK("shared io_context, 64 connections") {
+            return FetchConcurrently(server.GetEndpoint(), num_clients, connections_per_client);
+        };
+    }
+    {
+        TestServer server{ListenMode::PER_THREAD, num_threads};
+        BENCHMARK("io_context per thread, 64 connections") {
+            return FetchConcurrently(server.GetEndpoint(), num_clients, connections_per_client);
+        };
+    }
+}
+
+SCENARIO("HTTP pipelining") {
+    GIVEN("a connection to the server") {
+        net::io_context ioc;
+        tcp::acceptor acceptor{ioc, {net::ip::make_address("127.0.0.1"), 0}};
+        acceptor.async_accept(net::make_strand(ioc), [&ioc](sys::error_code ec, tcp::socket socket) {
+            if (!ec) {
+                std::make_shared<Session<EchoHandler>>(std::move(socket), EchoHandler{ioc})->Run();
+            }
+        });
+        std::jthread server{[&ioc] {
+            ioc.run();
+        }};
+
+        net::io_context client_ioc;
+        tcp::socket client{client_ioc};
+        client.connect(acceptor.local_endpoint());
+
+        WHEN("several requests are sent without waiting for responses") {
+            const auto requests = "GET /slow HTTP/1.1\r\nHost: x\r\n\r\n"
+                                  "GET /a HTTP/1.1\r\nHost: x\r\n\r\n"
+                                  "GET /b HTTP/1.1\r\nHost: x\r\nConnection: close\r\n\r\n"s;
+            net::write(client, net::buffer(requests));
+
+            THEN("responses arrive in the order of requests and the connection is closed") {
+                beast::flat_buffer buffer;
+                std::vector<std::string> bodies;
+                for (;;) {
+                    StringResponse res;
+                    beast::error_code ec;
+                    http::read(client, buffer, res, ec);
+                    if (ec) {
+                        CHECK(ec == http::error::end_of_stream);
+                        break;
+                    }
+                    bodies.push_back(res.body());
+                }
+                CHECK(bodies == std::vector{"/slow"s, "/a"s, "/b"s});
+            }
+        }
+
+        WHEN("responses without a body are pipelined") {
+            const auto requests = "GET /not-modified HTTP/1.1\r\nHost: x\r\n\r\n"
+                                  "HEAD /head HTTP/1.1\r\nHost: x\r\n\r\n"
+                                  "GET /c HTTP/1.1\r\nHost: x\r\nConnection: close\r\n\r\n"s;
+            net::write(client, net::buffer(requests));
+
+            THEN("each response keeps its status line") {
+                beast::flat_buffer buffer;
+                http::response<http::string_body> not_modified;
+                http::read(client, buffer, not_modified);
+                CHECK(not_modified.result() == http::status::not_modified);
+                CHECK(not_modified[http::field::etag] == "\"tag\"");
+
+                http::response_parser<http::string_body> head;
+                // Ответ на HEAD объявляет длину тела, но не содержит его
+                head.skip(true);
+                http::read(client, buffer, head);
+                CHECK(head.get().result() == http::status::ok);
+                CHECK(head.get().version() == 11);
+                CHECK(head.get()[http::field::content_length] == "5");
+
+                StringResponse last;
+                http::read(client, buffer, last);
+                CHECK(last.body() == "/c");
+            }
+        }
+    }
+}
@@ -0,0 +1,137 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../src/json_serializer.h"
+
+using namespace std::literals;
+
+namespace {
+
+using Dogs = std::vector<std::unique_ptr<model::Dog>>;
+
+// Прежняя сериализация состояния через DOM
+std::string ReferenceGameState(const std::vector<model::Dog*>& dogs) {
+    json::object players_obj;
+    for (const auto& dog_ptr : dogs) {
+        players_obj[std::to_string(*dog_ptr->GetId())] = json_serializer::ToJson(*dog_ptr);
+    }
+    json::object root_obj;
+    root_obj["players"] = players_obj;
+    return json::serialize(root_obj);
+}
+
+std::vector<model::Dog*> MakeDogs(Dogs& storage, size_t count, std::mt19937_64& generator) {
+    std::uniform_real_distribution<double> coord{-100.0, 100.0};
+    const std::string directions[] = {"L"s, "R"s, "U"s, "D"s};
+    std::vector<model::Dog*> dogs;
+    for (size_t i = 0; i < count; ++i) {
+        auto& dog = storage.emplace_back(std::make_unique<model::Dog>("dog"s));
+        dog->SetId(model::Dog::Id{i * 7919});
+        dog->SetPosition({coord(generator), coord(generator)});
+        dog->SetSpeed({generator() % 2 ? 0.0 : coord(generator), -0.0});
+        dog->SetDirection(directions[generator() % 4]);
+        dogs.push_back(dog.get());
+    }
+    return dogs;
+}
+
+}  // namespace
+
+SCENARIO("Double formatting") {
+    auto reference = [](double value) {
+        return json::serialize(json::value(value));
+    };
+    auto streamed = [](double value) {
+        std::string out;
+        json_serializer::AppendDouble(out, value);
+        return out;
+    };
+
+    GIVEN("special values") {
+        for (double value : {0.0, -0.0, 1.0, -1.0, 0.4, 10.0, 123.456, 1e-7, 1e21, 5e-324,
+                             std::numeric_limits<double>::max(), std::numeric_limits<double>::min()}) {
+            CHECK(streamed(value) == reference(value));
+        }
+    }
+
+    GIVEN("random bit patterns") {
+        std::mt19937_64 generator{3};
+        size_t mismatches = 0;
+        for (int i = 0; i < 100000; ++i) {
+            const uint64_t bits = generator();
+            double value;
+            std::memcpy(&value, &bits, sizeof(value));
+            if (std::isfinite(value) && streamed(value) != reference(value)) {
+                ++mismatches;
+            }
+        }
+        CHECK(mismatches == 0);
+    }
+}
+
+SCENARIO("Streaming game state") {
+    std::mt19937_64 generator{5};
+    Dogs storage;
+
+    GIVEN("no dogs") {
+        std::string out;
+        json_serializer::AppendGameState(out, {});
+        CHECK(out == ReferenceGameState({}));
+    }
+
+    GIVEN("a session with dogs") {
+        const auto dogs = MakeDogs(storage, 1000, generator);
+        THEN("the output is byte-for-byte equal to the DOM serialization") {
+            std::string out;
+            json_serializer::AppendGameState(out, dogs);
+            CHECK(out == ReferenceGameState(dogs));
+        }
+    }
+}
+
+SCENARIO("Game state delta") {
+    std::mt19937_64 generator{7};
+    Dogs storage;
+    const auto dogs = MakeDogs(storage, 100, generator);
+
+    THEN("players are serialized as in the full state") {
+        std::string state;
+        json_serializer::AppendGameState(state, dogs);
+        const auto state_obj = json::parse(state).as_object();
+
+        std::string delta;
+        json_serializer::AppendGameStateDelta(delta, 42, false, dogs);
+        const auto delta_obj = json::parse(delta).as_object();
+
+        CHECK(delta_obj.at("version").as_int64() == 42);
+        CHECK(delta_obj.at("full").as_bool() == false);
+        CHECK(delta_obj.at("players") == state_obj.at("players"));
+    }
+
+    THEN("a full snapshot is marked") {
+        std::string delta;
+        json_serializer::AppendGameStateDelta(delta, 7, true, {});
+        CHECK(delta == R"({"version":7,"full":true,"players":{}})"sv);
+    }
+}
+
+TEST_CASE("Game state serialization benchmark", "[!benchmark]") {
+    std::mt19937_64 generator{5};
+    Dogs storage;
+    const auto dogs = MakeDogs(storage, 10000, generator);
+
+    BENCHMARK("DOM serialization, 10k dogs") {
+        return ReferenceGameState(dogs);
+    };
+    BENCHMARK("streaming serialization, 10k dogs") {
+        std::string out;
+        json_serializer::AppendGameState(out, dogs);
+        return out;
+    };
+}
@@ -0,0 +1,322 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <atomic>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "../src/model.h"
+#include "test-maps.h"
+
+using namespace model;
+using namespace std::literals;
+using test_maps::MakeCityMap;
+
+namespace {
+
+bool IsOnRoad(const Road& road, PointD pos) {
+    const auto start = road.GetStart();
+    const auto end = road.GetEnd();
+    return pos.x >= std::min(start.x, end.x) - Road::HALF_WIDTH && pos.x <= std::max(start.x, end.x) + Road::HALF_WIDTH
+        && pos.y >= std::min(start.y, end.y) - Road::HALF_WIDTH && pos.y <= std::max(start.y, end.y) + Road::HALF_WIDTH;
+}
+
+std::vector<PointD> MakeRandomPoints(const Map& map, size_t count) {
+    std::mt19937_64 generator{42};
+    const auto& roads = map.GetRoads();
+    std::uniform_int_distribution<size_t> road_dist{0, roads.size() - 1};
+    std::uniform_real_distribution<double> offset_dist{-0.5, 0.5};
+    std::uniform_real_distribution<double> along_dist{0.0, 1.0};
+
+    std::vector<PointD> points;
+    points.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        const auto& road = roads[road_dist(generator)];
+        const auto start = road.GetStart();
+        const auto end = road.GetEnd();
+        const double t = along_dist(generator);
+        points.push_back({start.x + (end.x - start.x) * t + offset_dist(generator),
+                          start.y + (end.y - start.y) * t + offset_dist(generator)});
+    }
+    return points;
+}
+
+std::vector<size_t> FindRoadsLinear(const Map& map, PointD pos) {
+    std::vector<size_t> result;
+    const auto& roads = map.GetRoads();
+    for (size_t i = 0; i < roads.size(); ++i) {
+        if (IsOnRoad(roads[i], pos)) {
+            result.push_back(i);
+        }
+    }
+    return result;
+}
+
+std::vector<size_t> FindRoadsOnGrid(const Map& map, PointD pos) {
+    std::vector<size_t> result;
+    const auto& borders = map.GetRoadBorders();
+    for (size_t index : map.GetRoadGrid().FindRoads(pos)) {
+        if (borders.Contains(index, pos)) {
+            result.push_back(index);
+        }
+    }
+    return result;
+}
+
+}  // namespace
+
+SCENARIO("Road borders") {
+    GIVEN("a map with roads in both directions") {
+        Map map{Map::Id{"map"s}, "Map"s};
+        map.AddRoad(Road{Road::HORIZONTAL, {10, 5}, 2});
+        map.AddRoad(Road{Road::VERTICAL, {3, 4}, 9});
+        const auto& borders = map.GetRoadBorders();
+
+        THEN("borders are stored for every road") {
+            REQUIRE(borders.Size() == 2);
+            CHECK(borders.x_min[0] == 2 - Road::HALF_WIDTH);
+            CHECK(borders.x_max[0] == 10 + Road::HALF_WIDTH);
+            CHECK(borders.y_min[0] == 5 - Road::HALF_WIDTH);
+            CHECK(borders.y_max[0] == 5 + Road::HALF_WIDTH);
+            CHECK(borders.x_min[1] == 3 - Road::HALF_WIDTH);
+            CHECK(borders.x_max[1] == 3 + Road::HALF_WIDTH);
+            CHECK(borders.y_min[1] == 4 - Road::HALF_WIDTH);
+            CHECK(borders.y_max[1] == 9 + Road::HALF_WIDTH);
+        }
+
+        THEN("they agree with the road geometry") {
+            for (const auto& pos : MakeRandomPoints(map, 1'000)) {
+                const auto& roads = map.GetRoads();
+                for (size_t i = 0; i < roads.size(); ++i) {
+                    CHECK(borders.Contains(i, pos) == IsOnRoad(roads[i], pos));
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("Road grid lookup") {
+    GIVEN("a city map") {
+        const Map map = MakeCityMap(20, 10);
+
+        THEN("grid finds the same roads as the linear scan") {
+            for (const auto& pos : MakeRandomPoints(map, 10'000)) {
+                CHECK(FindRoadsOnGrid(map, pos) == FindRoadsLinear(map, pos));
+            }
+        }
+
+        THEN("points outside the roads have no roads") {
+            CHECK(FindRoadsOnGrid(map, {5.0, 5.0}).empty());
+            CHECK(FindRoadsOnGrid(map, {-0.5, 0.0}).empty());
+            CHECK(FindRoadsOnGrid(map, {-100.0, -100.0}).empty());
+        }
+    }
+
+    GIVEN("a map with roads at negative coordinates") {
+        Map map{Map::Id{"neg"s}, "Negative"s};
+        map.AddRoad(Road{Road::HORIZONTAL, {-20, -3}, -1});
+        map.AddRoad(Road{Road::VERTICAL, {-1, -3}, -17});
+
+        THEN("grid finds the same roads as the linear scan") {
+            for (const auto& pos : MakeRandomPoints(map, 1'000)) {
+                CHECK(FindRoadsOnGrid(map, pos) == FindRoadsLinear(map, pos));
+            }
+        }
+    }
+}
+
+SCENARIO("Dog movement") {
+    GIVEN("a session on a map with crossing roads") {
+        Map map{Map::Id{"map"s}, "Map"s};
+        map.AddRoad(Road{Road::HORIZONTAL, {0, 0}, 10});
+        map.AddRoad(Road{Road::VERTICAL, {10, 0}, 10});
+        GameSession session{&map};
+        Dog dog{"Rex"s};
+        session.AddDog(&dog);
+
+        WHEN("the dog moves along the road") {
+            dog.SetSpeed({1.0, 0.0});
+            session.Tick(2500ms);
+
+            THEN("it keeps moving") {
+                CHECK(dog.GetPosition().x == 2.5);
+                CHECK(dog.GetPosition().y == 0.0);
+                CHECK(dog.GetSpeed().u == 1.0);
+            }
+        }
+
+        WHEN("the dog reaches the end of the road") {
+            dog.SetSpeed({-1.0, 0.0});
+            session.Tick(1s);
+
+            THEN("it stops at the road border") {
+                CHECK(dog.GetPosition().x == -0.4);
+                CHECK(dog.GetSpeed().u == 0.0);
+            }
+        }
+
+        WHEN("the dog turns on the crossroad") {
+            dog.SetPosition({10.0, 0.0});
+            dog.SetSpeed({0.0, 3.0});
+            session.Tick(1s);
+
+            THEN("it moves along the crossing road") {
+                CHECK(dog.GetPosition().x == 10.0);
+                CHECK(dog.GetPosition().y == 3.0);
+            }
+        }
+    }
+}
+
+SCENARIO("Session change journal") {
+    GIVEN("a session with a moving and an idle dog") {
+        Map map{Map::Id{"map"s}, "Map"s};
+        map.AddRoad(Road{Road::HORIZONTAL, {0, 0}, 100});
+        GameSession session{&map};
+        Dog runner{"Rex"s};
+        runner.SetId(Dog::Id{1});
+        Dog sleeper{"Bim"s};
+        sleeper.SetId(Dog::Id{2});
+        session.AddDog(&runner);
+        session.AddDog(&sleeper);
+
+        THEN("everything joined since the start is reported") {
+            const auto changed = session.GetDogsChangedSince(0);
+            REQUIRE(changed);
+            CHECK(*changed == std::vector<Dog*>{&runner, &sleeper});
+        }
+
+        WHEN("only one dog moves") {
+            session.SetDogMovement(&runner, {1.0, 0.0}, "R"s);
+            const auto version = session.GetVersion();
+            session.Tick(1s);
+            session.Tick(1s);
+
+            THEN("idle dogs are left out") {
+                const auto changed = session.GetDogsChangedSince(version);
+                REQUIRE(changed);
+                CHECK(*changed == std::vector<Dog*>{&runner});
+            }
+            THEN("nothing changed since the current version") {
+                const auto changed = session.GetDogsChangedSince(session.GetVersion());
+                REQUIRE(changed);
+                CHECK(changed->empty());
+            }
+            THEN("a version from the future is not covered") {
+                CHECK_FALSE(session.GetDogsChangedSince(session.GetVersion() + 1));
+            }
+        }
+
+        WHEN("dogs change several times out of id order") {
+            Dog newcomer{"Tuzik"s};
+            newcomer.SetId(Dog::Id{0});
+            const auto version = session.GetVersion();
+            session.SetDogMovement(&sleeper, {0.0, 1.0}, "D"s);
+            session.AddDog(&newcomer);
+            session.SetDogMovement(&runner, {1.0, 0.0}, "R"s);
+            session.SetDogMovement(&sleeper, {1.0, 0.0}, "R"s);
+            session.Tick(1s);
+
+            THEN("each dog is reported once, by ascending id") {
+                const auto changed = session.GetDogsChangedSince(version);
+                REQUIRE(changed);
+                CHECK(*changed == std::vector<Dog*>{&newcomer, &runner, &sleeper});
+            }
+        }
+
+        WHEN("the journal overflows") {
+            session.SetDogMovement(&runner, {1.0, 0.0}, "R"s);
+            for (size_t i = 0; i <= GameSession::JOURNAL_CAPACITY; ++i) {
+                session.Tick(1ms);
+            }
+
+            THEN("old versions need a full snapshot") {
+                CHECK_FALSE(session.GetDogsChangedSince(0));
+                CHECK(session.GetDogsChangedSince(session.GetVersion() - 1));
+            }
+        }
+    }
+}
+
+SCENARIO("Session storage under concurrent joins") {
+    GIVEN("a game with thousands of maps") {
+        constexpr size_t MAP_COUNT = 2'000;
+        constexpr size_t THREAD_COUNT = 8;
+        Game game;
+        for (size_t i = 0; i < MAP_COUNT; ++i) {
+            Map map{Map::Id{"map"s + std::to_string(i)}, "Map"s};
+            map.AddRoad(Road{Road::HORIZONTAL, {0, 0}, 10});
+            game.AddMap(std::move(map));
+        }
+
+        WHEN("threads join all maps at the same time") {
+            // sessions[t][m] - сессия карты m, полученная потоком t
+            std::vector<std::vector<GameSession*>> sessions(THREAD_COUNT, std::vector<GameSession*>(MAP_COUNT));
+            std::vector<std::vector<std::unique_ptr<Dog>>> dogs(THREAD_COUNT);
+            // Catch2 не поддерживает проверки из нескольких потоков, поэтому считаем ошибки сами
+            std::atomic<size_t> lookup_mismatches = 0;
+            {
+                std::vector<std::jthread> threads;
+                for (size_t t = 0; t < THREAD_COUNT; ++t) {
+                    threads.emplace_back([&, t] {
+                        for (size_t i = 0; i < MAP_COUNT; ++i) {
+                            // Потоки обходят карты в разном порядке
+                            const size_t m = t % 2 ? i : MAP_COUNT - 1 - i;
+                            const Map::Id id{"map"s + std::to_string(m)};
+                            GameSession* session = game.AddSession(id);
+                            sessions[t][m] = session;
+                            if (game.FindSession(id) != session) {
+                                ++lookup_mismatches;
+                            }
+                            // Собак в сессию добавляет только поток, которому принадлежит карта
+                            if (m % THREAD_COUNT == t) {
+                                session->AddDog(dogs[t].emplace_back(std::make_unique<Dog>("dog"s)).get());
+                            }
+                        }
+                    });
+                }
+            }
+
+            THEN("every map has exactly one session with a stable address") {
+                CHECK(lookup_mismatches == 0);
+                CHECK(game.GetSessions().size() == MAP_COUNT);
+                for (size_t m = 0; m < MAP_COUNT; ++m) {
+                    const Map::Id id{"map"s + std::to_string(m)};
+                    GameSession* session = game.FindSession(id);
+                    REQUIRE(session != nullptr);
+                    CHECK(session->GetMap() == game.FindMap(id));
+                    CHECK(session->GetDogs().size() == 1);
+                    for (size_t t = 0; t < THREAD_COUNT; ++t) {
+                        CHECK(sessions[t][m] == session);
+                    }
+                }
+                // Снимок сессий годится для тика, как в Application::Tick
+                for (GameSession* session : game.GetSessions()) {
+                    session->Tick(100ms);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Road lookup benchmark", "[!benchmark]") {
+    const Map map = MakeCityMap(50, 10);
+    const auto points = MakeRandomPoints(map, 1'000);
+
+    BENCHMARK("linear scan") {
+        size_t found = 0;
+        for (const auto& pos : points) {
+            found += FindRoadsLinear(map, pos).size();
+        }
+        return found;
+    };
+
+    BENCHMARK("road grid") {
+        size_t found = 0;
+        for (const auto& pos : points) {
+            found += FindRoadsOnGrid(map, pos).size();
+        }
+        return found;
+    };
+}
@@ -0,0 +1,157 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "../src/model.h"
+#include "test-maps.h"
+
+using namespace model;
+using namespace std::literals;
+using test_maps::MakeCityMap;
+
+namespace {
+
+// Перемещение собаки в том виде, в каком его выполнял GameSession::Tick до сетки дорог
+void ReferenceMove(const Map& map, Dog& dog, std::chrono::milliseconds delta) {
+    const double delta_s = static_cast<double>(delta.count()) / 1000.0;
+    if (dog.GetSpeed().u == 0.0 && dog.GetSpeed().v == 0.0) {
+        return;
+    }
+
+    const auto start_pos = dog.GetPosition();
+    const auto speed = dog.GetSpeed();
+    const PointD end_pos_estimated{start_pos.x + speed.u * delta_s, start_pos.y + speed.v * delta_s};
+
+    const auto& borders = map.GetRoadBorders();
+    std::vector<size_t> current_roads;
+    for (size_t i = 0; i < map.GetRoads().size(); ++i) {
+        if (borders.Contains(i, start_pos)) {
+            current_roads.push_back(i);
+        }
+    }
+    if (current_roads.empty()) {
+        dog.SetSpeed({0.0, 0.0});
+        return;
+    }
+
+    PointD final_pos = start_pos;
+    double max_dist_sq = -1.0;
+    for (size_t index : current_roads) {
+        PointD bounded_pos{std::clamp(end_pos_estimated.x, borders.x_min[index], borders.x_max[index]),
+                           std::clamp(end_pos_estimated.y, borders.y_min[index], borders.y_max[index])};
+        double dist_sq = std::pow(bounded_pos.x - start_pos.x, 2) + std::pow(bounded_pos.y - start_pos.y, 2);
+        if (dist_sq > max_dist_sq) {
+            max_dist_sq = dist_sq;
+            final_pos = bounded_pos;
+        }
+    }
+    dog.SetPosition(final_pos);
+    if (!(std::abs(final_pos.x - end_pos_estimated.x) < 1e-9 && std::abs(final_pos.y - end_pos_estimated.y) < 1e-9)) {
+        dog.SetSpeed({0.0, 0.0});
+    }
+}
+
+bool SameBits(double lhs, double rhs) {
+    return std::bit_cast<uint64_t>(lhs) == std::bit_cast<uint64_t>(rhs);
+}
+
+struct Pack {
+    std::vector<std::unique_ptr<Dog>> dogs;
+    GameSession session;
+
+    Pack(const Map& map, size_t dog_count)
+        : session{&map} {
+        for (size_t i = 0; i < dog_count; ++i) {
+            session.AddDog(dogs.emplace_back(std::make_unique<Dog>("dog"s)).get());
+        }
+    }
+};
+
+// Раздаёт собакам случайные позиции на дорогах и случайные скорости, часть собак стоит на месте
+void Scatter(const Map& map, std::vector<Dog*> dogs, std::mt19937_64& generator) {
+    const auto& roads = map.GetRoads();
+    std::uniform_int_distribution<size_t> road_dist{0, roads.size() - 1};
+    std::uniform_real_distribution<double> along_dist{0.0, 1.0};
+    std::uniform_int_distribution<int> dir_dist{0, 4};
+    std::uniform_real_distribution<double> speed_dist{0.1, 20.0};
+    for (auto* dog : dogs) {
+        const auto& road = roads[road_dist(generator)];
+        const double t = along_dist(generator);
+        dog->SetPosition({road.GetStart().x + (road.GetEnd().x - road.GetStart().x) * t,
+                          road.GetStart().y + (road.GetEnd().y - road.GetStart().y) * t});
+        const double speed = speed_dist(generator);
+        switch (dir_dist(generator)) {
+            case 0: dog->SetSpeed({-speed, 0.0}); break;
+            case 1: dog->SetSpeed({speed, 0.0}); break;
+            case 2: dog->SetSpeed({0.0, -speed}); break;
+            case 3: dog->SetSpeed({0.0, speed}); break;
+            default: dog->SetSpeed({0.0, 0.0}); break;
+        }
+    }
+}
+
+std::vector<Dog*> Raw(const std::vector<std::unique_ptr<Dog>>& dogs) {
+    std::vector<Dog*> result;
+    for (const auto& dog : dogs) {
+        result.push_back(dog.get());
+    }
+    return result;
+}
+
+}  // namespace
+
+SCENARIO("Session movement matches the reference movement") {
+    const Map map = MakeCityMap(10, 7);
+    constexpr size_t DOG_COUNT = 1'003;
+
+    GIVEN("dogs in a session and their copies") {
+        Pack pack{map, DOG_COUNT};
+        std::vector<Dog> reference;
+        std::mt19937_64 generator{1};
+        std::uniform_int_distribution<int> delta_dist{0, 3'000};
+
+        for (int round = 0; round < 20; ++round) {
+            Scatter(map, Raw(pack.dogs), generator);
+            reference.clear();
+            for (const auto& dog : pack.dogs) {
+                reference.push_back(*dog);
+            }
+
+            for (int tick = 0; tick < 5; ++tick) {
+                const std::chrono::milliseconds delta{delta_dist(generator)};
+                pack.session.Tick(delta);
+                for (auto& dog : reference) {
+                    ReferenceMove(map, dog, delta);
+                }
+
+                for (size_t i = 0; i < DOG_COUNT; ++i) {
+                    const auto& dog = *pack.dogs[i];
+                    const auto& expected = reference[i];
+                    REQUIRE(SameBits(dog.GetPosition().x, expected.GetPosition().x));
+                    REQUIRE(SameBits(dog.GetPosition().y, expected.GetPosition().y));
+                    REQUIRE(SameBits(dog.GetSpeed().u, expected.GetSpeed().u));
+                    REQUIRE(SameBits(dog.GetSpeed().v, expected.GetSpeed().v));
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Session tick benchmark", "[!benchmark]") {
+    const Map map = MakeCityMap(50, 10);
+    constexpr size_t DOG_COUNT = 10'000;
+    Pack pack{map, DOG_COUNT};
+    std::mt19937_64 generator{42};
+
+    BENCHMARK_ADVANCED("tick 10k dogs")(Catch::Benchmark::Chronometer meter) {
+        Scatter(map, Raw(pack.dogs), generator);
+        meter.measure([&] {
+            pack.session.Tick(100ms);
+        });
+    };
+}
@@ -0,0 +1,169 @@
+#include <catch2/catch_test_macros.hpp>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+
+#include "../src/http_server.h"
+#include "../src/response_queue.h"
+#include "../src/message_allocator.h"
+
+using namespace std::literals;
+using namespace http_server;
+
+namespace {
+
+std::atomic<size_t> allocation_count{0};
+
+}  // namespace
+
+// Подсчёт обращений к куче. Замена действует на всю программу, поэтому
+// в этот исполняемый файл не входят другие тесты
+void* operator new(std::size_t size) {
+    ++allocation_count;
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+using PooledResponse = http::response<http::string_body, ResponseFields>;
+using PooledEmptyResponse = http::response<http::empty_body, ResponseFields>;
+
+PooledResponse MakeResponse(std::string_view content_type) {
+    // Тело короче буфера малой строки и не требует памяти
+    PooledResponse res{http::status::ok, 11};
+    res.set(http::field::content_type, beast::string_view{content_type.data(), content_type.size()});
+    res.set(http::field::cache_control, "no-cache");
+    res.body() = "{}";
+    res.prepare_payload();
+    res.keep_alive(true);
+    return res;
+}
+
+// Один цикл работы соединения: ответы ставятся в очередь, собираются в буферы и освобождаются.
+// Если задан written, в него копируются отправляемые данные
+void WriteBatch(ResponseQueue& queue, uint64_t& next_id, std::vector<net::const_buffer>& buffers, std::string* written = nullptr) {
+    const uint64_t first_id = next_id;
+    for (uint64_t i = 0; i < ResponseQueue::CAPACITY; ++i) {
+        if (i % 2 == 0) {
+            queue.Emplace<detail::PendingResponse<http::string_body, ResponseFields>>(next_id++, MakeResponse("application/json"sv));
+        } else {
+            PooledEmptyResponse res{http::status::not_modified, 11};
+            res.set(http::field::etag, "\"1\"");
+            queue.Emplace<detail::PendingResponse<http::empty_body, ResponseFields>>(next_id++, std::move(res));
+        }
+    }
+    buffers.clear();
+    for (uint64_t offset = 0; queue.IsReady(offset); ++offset) {
+        queue.Get(offset).AppendBuffers(buffers);
+    }
+    if (written) {
+        for (auto buffer : buffers) {
+            written->append(static_cast<const char*>(buffer.data()), buffer.size());
+        }
+    }
+    queue.Release(next_id - first_id);
+}
+
+// Отвечает на любой запрос ответом, размещённым в памяти MessageAllocator
+struct PooledHandler {
+    template <typename Request, typename Send, typename Endpoint>
+    void operator()(Request&&, Send&& send, const Endpoint&) const {
+        send(MakeResponse("application/json"sv));
+    }
+};
+
+}  // namespace
+
+SCENARIO("Response queue") {
+    GIVEN("a queue warmed up by previous responses") {
+        ResponseQueue queue;
+        uint64_t next_id = 0;
+        std::vector<net::const_buffer> buffers;
+        buffers.reserve(ResponseQueue::CAPACITY * 4);
+        WriteBatch(queue, next_id, buffers);
+
+        THEN("the queue places, serializes and releases responses without heap allocations") {
+            const size_t before = allocation_count;
+            for (int i = 0; i < 100; ++i) {
+                WriteBatch(queue, next_id, buffers);
+            }
+            const size_t after = allocation_count;
+            CHECK(after == before);
+            CHECK(queue.GetFirstId() == next_id);
+        }
+
+        THEN("buffers hold whole responses in request order") {
+            std::string data;
+            WriteBatch(queue, next_id, buffers, &data);
+            CHECK(data.find("HTTP/1.1 200 OK\r\n") == 0);
+            CHECK(data.find("HTTP/1.1 304 Not Modified\r\n") > data.find("{}"));
+        }
+    }
+}
+
+SCENARIO("Connection steady state") {
+    GIVEN("a connection warmed up by previous requests") {
+        net::io_context ioc{1};
+        tcp::acceptor acceptor{ioc, {net::ip::make_address("127.0.0.1"), 0}};
+        acceptor.async_accept(ioc.get_executor(), [](sys::error_code ec, tcp::socket socket) {
+            if (!ec) {
+                std::make_shared<Session<PooledHandler>>(std::move(socket), PooledHandler{})->Run();
+            }
+        });
+        auto work = net::make_work_guard(ioc);
+        std::jthread server{[&ioc] {
+            ioc.run();
+        }};
+
+        net::io_context client_ioc;
+        tcp::socket client{client_ioc};
+        client.connect(acceptor.local_endpoint());
+        const std::string request = "GET /api/v1/game/state HTTP/1.1\r\nHost: localhost\r\n\r\n";
+        std::ostringstream expected;
+        expected << MakeResponse("application/json"sv);
+        std::string response(expected.str().size(), '\0');
+        auto round_trip = [&] {
+            net::write(client, net::buffer(request));
+            net::read(client, net::buffer(response));
+        };
+        for (int i = 0; i < 100; ++i) {
+            round_trip();
+        }
+
+        WHEN("the client sends more requests") {
+            constexpr size_t REQUEST_COUNT = 1000;
+            const size_t before = allocation_count;
+            for (size_t i = 0; i < REQUEST_COUNT; ++i) {
+                round_trip();
+            }
+            const size_t after = allocation_count;
+
+            THEN("reading requests and writing responses allocate only for the stream timeout") {
+                CHECK(response == expected.str());
+                // Обработчик таймера tcp_stream создаётся внутри Beast и не использует
+                // память соединения: не больше одного выделения на запрос
+                CHECK(after - before <= REQUEST_COUNT);
+            }
+        }
+
+        work.reset();
+        ioc.stop();
+    }
+}
@@ -0,0 +1,67 @@
+#include <catch2/catch_test_macros.hpp>
+#include <string>
+
+#include "../src/json_serializer.h"
+#include "../src/state_cache.h"
+
+using namespace model;
+using namespace http_handler;
+using namespace std::literals;
+
+SCENARIO("Game state cache") {
+    GIVEN("a session with a dog") {
+        Map map{Map::Id{"map"s}, "Map"s};
+        map.AddRoad(Road{Road::HORIZONTAL, {0, 0}, 10});
+        GameSession session{&map};
+        Dog dog{"Rex"s};
+        session.AddDog(&dog);
+        StateCache cache;
+
+        const auto state = cache.GetState(session);
+
+        THEN("it holds the serialized state") {
+            std::string expected;
+            json_serializer::AppendGameState(expected, session.GetDogs());
+            CHECK(*state == expected);
+        }
+
+        WHEN("the session does not change") {
+            THEN("readers share the same buffer") {
+                CHECK(cache.GetState(session) == state);
+            }
+        }
+
+        WHEN("the dog changes direction") {
+            const auto version = session.GetVersion();
+            session.SetDogMovement(&dog, {1.0, 0.0}, "R"s);
+
+            THEN("the state is serialized again") {
+                CHECK(session.GetVersion() != version);
+                const auto new_state = cache.GetState(session);
+                CHECK(new_state != state);
+                CHECK(new_state->find("\"dir\":\"R\""sv) != std::string::npos);
+            }
+        }
+
+        WHEN("the session ticks") {
+            const auto version = session.GetVersion();
+            session.Tick(1s);
+
+            THEN("the state is serialized again") {
+                CHECK(session.GetVersion() != version);
+                CHECK(cache.GetState(session) != state);
+            }
+        }
+
+        WHEN("another dog joins") {
+            Dog other{"Bim"s};
+            session.AddDog(&other);
+
+            THEN("the new dog appears in the state") {
+                const auto new_state = cache.GetState(session);
+                CHECK(new_state != state);
+                CHECK(new_state->size() > state->size());
+            }
+        }
+    }
+}
@@ -0,0 +1,71 @@
+#include <catch2/catch_test_macros.hpp>
+#include <boost/asio/io_context.hpp>
+#include <memory>
+#include <string>
+
+#include "../src/state_subscribers.h"
+
+using namespace model;
+using namespace http_handler;
+using namespace std::literals;
+namespace net = boost::asio;
+
+SCENARIO("State subscribers") {
+    GIVEN("a session") {
+        Map map{Map::Id{"map"s}, "Map"s};
+        GameSession session{&map};
+        StateSubscribers subscribers;
+        net::io_context ioc;
+
+        size_t frames_built = 0;
+        auto make_frame = [&frames_built](StateFormat) {
+            ++frames_built;
+            return std::make_shared<const std::string>("{}"s);
+        };
+
+        WHEN("nobody is subscribed") {
+            subscribers.Publish(session, make_frame);
+
+            THEN("no frame is built") {
+                CHECK(frames_built == 0);
+            }
+        }
+
+        WHEN("players want different formats") {
+            auto json = std::make_shared<http_server::WebSocketSession>(ioc.get_executor());
+            auto binary = std::make_shared<http_server::WebSocketSession>(ioc.get_executor());
+            auto other_binary = std::make_shared<http_server::WebSocketSession>(ioc.get_executor());
+            subscribers.Add(session, json);
+            subscribers.Add(session, binary, StateFormat::BINARY);
+            subscribers.Add(session, other_binary, StateFormat::BINARY);
+            subscribers.Publish(session, make_frame);
+
+            THEN("one frame is built per format") {
+                CHECK(frames_built == 2);
+            }
+        }
+
+        WHEN("several players are subscribed") {
+            auto first = std::make_shared<http_server::WebSocketSession>(ioc.get_executor());
+            auto second = std::make_shared<http_server::WebSocketSession>(ioc.get_executor());
+            subscribers.Add(session, first);
+            subscribers.Add(session, second);
+            subscribers.Publish(session, make_frame);
+
+            THEN("one frame is built for all of them") {
+                CHECK(frames_built == 1);
+            }
+
+            AND_WHEN("their connections are gone") {
+                ioc.run();
+                first.reset();
+                second.reset();
+                subscribers.Publish(session, make_frame);
+
+                THEN("they are unsubscribed") {
+                    CHECK(frames_built == 1);
+                }
+            }
+        }
+    }
+}
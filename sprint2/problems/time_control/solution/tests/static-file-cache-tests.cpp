@@ -0,0 +1,192 @@
+#include <catch2/catch_test_macros.hpp>
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <chrono>
+#include <fstream>
+#include <random>
+#include <string>
+
+#include "../src/http_cache.h"
+#include "../src/static_file_cache.h"
+
+using namespace std::literals;
+using namespace http_handler;
+
+namespace {
+
+// Временный каталог, удаляемый вместе с содержимым
+class TempDirectory {
+public:
+    TempDirectory()
+        : path_(fs::temp_directory_path() / ("static-cache-" + std::to_string(std::random_device{}()))) {
+        fs::create_directories(path_);
+    }
+
+    ~TempDirectory() {
+        std::error_code ec;
+        fs::remove_all(path_, ec);
+    }
+
+    const fs::path& GetPath() const noexcept {
+        return path_;
+    }
+
+private:
+    fs::path path_;
+};
+
+void WriteFile(const fs::path& path, std::string_view content) {
+    fs::create_directories(path.parent_path());
+    std::ofstream file{path, std::ios::binary | std::ios::trunc};
+    file.write(content.data(), content.size());
+}
+
+std::string Gunzip(const std::string& compressed) {
+    namespace io = boost::iostreams;
+    std::string content;
+    io::filtering_istream in;
+    in.push(io::gzip_decompressor{});
+    in.push(io::array_source{compressed.data(), compressed.size()});
+    io::copy(in, io::back_inserter(content));
+    return content;
+}
+
+}  // namespace
+
+SCENARIO("Static file cache") {
+    GIVEN("a directory with static files") {
+        TempDirectory outside;
+        TempDirectory root;
+        WriteFile(root.GetPath() / "index.html", "<html></html>");
+        WriteFile(root.GetPath() / "assets/app.JS", "let x;");
+        WriteFile(root.GetPath() / "assets/model.fbx", std::string(100, 'm'));
+        WriteFile(outside.GetPath() / "secret.txt", "secret");
+        fs::create_symlink(outside.GetPath() / "secret.txt", root.GetPath() / "secret.txt");
+
+        WHEN("it is loaded into the cache") {
+            StaticFileCache cache{root.GetPath(), 1024, 64};
+
+            THEN("small files are served from memory with their type and ETag") {
+                auto entry = cache.Find("/assets/app.JS");
+                REQUIRE(entry);
+                REQUIRE(entry->body);
+                CHECK(*entry->body == "let x;");
+                CHECK(entry->size == 6);
+                CHECK(entry->content_type == "text/javascript");
+                CHECK(entry->path == fs::canonical(root.GetPath() / "assets/app.JS"));
+                CHECK(entry->etag.starts_with('"'));
+                const auto mtime = fs::last_write_time(root.GetPath() / "assets/app.JS");
+                CHECK(entry->last_modified == std::chrono::floor<std::chrono::seconds>(std::chrono::file_clock::to_sys(mtime)));
+                CHECK(ParseHttpDate(entry->last_modified_text) == entry->last_modified);
+                CHECK(cache.GetCachedSize() == 6 + "<html></html>"s.size());
+            }
+
+            THEN("directories resolve to their index.html") {
+                auto index = cache.Find("/index.html");
+                REQUIRE(index);
+                CHECK(cache.Find("/") == index);
+                CHECK(cache.Find("/assets") == nullptr);
+            }
+
+            THEN("files over the size limit keep only their metadata") {
+                auto entry = cache.Find("/assets/model.fbx");
+                REQUIRE(entry);
+                CHECK(entry->body == nullptr);
+                CHECK(entry->size == 100);
+                CHECK(entry->etag.starts_with("W/\""));
+            }
+
+            THEN("links leading outside the root are not cached") {
+                CHECK(cache.Find("/secret.txt") == nullptr);
+                CHECK(cache.Find("/missing.html") == nullptr);
+            }
+        }
+
+        WHEN("text files are large enough to compress") {
+            std::string script;
+            for (int i = 0; i < 200; ++i) {
+                script += "function f" + std::to_string(i) + "() { return " + std::to_string(i) + "; }\n";
+            }
+            WriteFile(root.GetPath() / "js/three.js", script);
+            WriteFile(root.GetPath() / "js/loader.js", script);
+            WriteFile(root.GetPath() / "js/loader.js.br", "brotli bytes");
+            WriteFile(root.GetPath() / "assets/data.bin", std::string(1000, 'b'));
+            StaticFileCache cache{root.GetPath()};
+
+            THEN("a gzip variant is built at startup") {
+                auto entry = cache.Find("/js/three.js");
+                REQUIRE(entry);
+                REQUIRE(entry->variants.size() == 1);
+                const auto& gzip = entry->variants[0];
+                CHECK(gzip.encoding == "gzip");
+                CHECK(gzip.body->size() < script.size());
+                CHECK(Gunzip(*gzip.body) == script);
+                CHECK(gzip.etag != entry->etag);
+                CHECK(cache.GetCachedSize() >= script.size() + gzip.body->size());
+            }
+
+            THEN("precompressed siblings on disk are preferred") {
+                auto entry = cache.Find("/js/loader.js");
+                REQUIRE(entry);
+                REQUIRE(entry->variants.size() == 2);
+                CHECK(entry->variants[0].encoding == "br");
+                CHECK(*entry->variants[0].body == "brotli bytes");
+                CHECK(entry->variants[1].encoding == "gzip");
+            }
+
+            THEN("binary files are left as is") {
+                auto entry = cache.Find("/assets/data.bin");
+                REQUIRE(entry);
+                CHECK(entry->variants.empty());
+            }
+
+            THEN("the best variant follows Accept-Encoding") {
+                auto entry = cache.Find("/js/loader.js");
+                REQUIRE(entry);
+                CHECK(entry->SelectVariant("gzip, deflate, br")->encoding == "br");
+                CHECK(entry->SelectVariant("gzip, br;q=0.5")->encoding == "gzip");
+                CHECK(entry->SelectVariant("gzip;q=0.5, identity;q=0.1")->encoding == "gzip");
+                CHECK(entry->SelectVariant("gzip;q=0.5, identity") == nullptr);
+                CHECK(entry->SelectVariant("") == nullptr);
+                CHECK(entry->SelectVariant("deflate") == nullptr);
+                CHECK(entry->SelectVariant("identity, gzip;q=0.5") == nullptr);
+            }
+        }
+
+        WHEN("the total size limit is smaller than the files") {
+            StaticFileCache cache{root.GetPath(), 10, 64};
+
+            THEN("only files that fit are held in memory") {
+                CHECK(cache.GetCachedSize() <= 10);
+                CHECK(cache.Find("/index.html"));
+                CHECK(cache.Find("/assets/app.JS"));
+            }
+        }
+
+        WHEN("the cache watches the directory and a file changes") {
+            net::io_context ioc;
+            StaticFileCache cache{root.GetPath()};
+            cache.Watch(ioc);
+            WriteFile(root.GetPath() / "assets/app.JS", "let y = 1;");
+            WriteFile(root.GetPath() / "assets/new/added.css", "a {}");
+
+            const auto deadline = std::chrono::steady_clock::now() + 5s;
+            auto updated = [&] {
+                auto changed = cache.Find("/assets/app.JS");
+                auto added = cache.Find("/assets/new/added.css");
+                return changed && changed->body && *changed->body == "let y = 1;" && added && added->body;
+            };
+            while (!updated() && std::chrono::steady_clock::now() < deadline) {
+                ioc.run_for(10ms);
+            }
+
+            THEN("the cache serves the new content") {
+                CHECK(updated());
+                CHECK(cache.Find("/assets/new/added.css")->content_type == "text/css");
+            }
+        }
+    }
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <string>
+#include <utility>
+
+#include "../src/model.h"
+
+namespace test_maps {
+
+// Карта-"город": сетка из горизонтальных и вертикальных улиц, разбитых на кварталы
+inline model::Map MakeCityMap(int blocks, int block_size, std::string id = "city") {
+    using model::Road;
+    model::Map map{model::Map::Id{std::move(id)}, "City"};
+    const model::Coord size = blocks * block_size;
+    for (model::Coord line = 0; line <= size; line += block_size) {
+        for (model::Coord from = 0; from < size; from += block_size) {
+            map.AddRoad(Road{Road::HORIZONTAL, {from, line}, from + block_size});
+            map.AddRoad(Road{Road::VERTICAL, {line, from}, from + block_size});
+        }
+    }
+    return map;
+}
+
+}  // namespace test_maps
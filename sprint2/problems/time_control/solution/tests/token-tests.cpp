@@ -0,0 +1,188 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cctype>
+#include <iomanip>
+#include <random>
+#include <regex>
+#include <sstream>
+#include <string>
+
+#include "../src/token.h"
+
+using namespace std::literals;
+
+namespace {
+
+// Прежнее строковое представление токена
+std::string ReferenceHex(uint64_t high, uint64_t low) {
+    std::stringstream ss;
+    ss << std::hex << std::setfill('0') << std::setw(16) << high << std::setw(16) << low;
+    return ss.str();
+}
+
+// Прежний разбор заголовка Authorization
+std::optional<app::Token> ReferenceParseBearer(const std::string& header) {
+    static const std::regex bearer_regex(R"(^Bearer\s+([0-9a-fA-F]{32})$)", std::regex::icase);
+    std::smatch match;
+    if (std::regex_match(header, match, bearer_regex)) {
+        return app::Token::FromHex(match[1].str());
+    }
+    return std::nullopt;
+}
+
+// Собирает заголовок из фрагментов, похожих на корректный, со случайными искажениями
+std::string MakeFuzzHeader(std::mt19937_64& generator) {
+    auto random = [&generator](size_t n) {
+        return static_cast<size_t>(generator() % n);
+    };
+    constexpr std::string_view SPACES = " \t\n\v\f\r";
+    constexpr std::string_view HEX = "0123456789abcdefABCDEF";
+
+    std::string header = "Bearer";
+    for (char& c : header) {
+        if (random(2)) {
+            c = static_cast<char>(c ^ 0x20);
+        }
+    }
+    for (size_t n = random(4); n > 0; --n) {
+        header += SPACES[random(SPACES.size())];
+    }
+    // Длина около 32, чтобы проверить границы
+    for (size_t n = 29 + random(7); n > 0; --n) {
+        header += HEX[random(HEX.size())];
+    }
+    for (size_t n = random(3); n > 0; --n) {
+        header.insert(header.begin() + random(header.size() + 1), static_cast<char>(random(256)));
+    }
+    if (random(4) == 0) {
+        header.erase(random(header.size()), 1);
+    }
+    return header;
+}
+
+}  // namespace
+
+SCENARIO("Token hex representation") {
+    std::mt19937_64 generator{42};
+
+    GIVEN("random tokens") {
+        THEN("encoding matches the former string tokens and decoding restores the token") {
+            size_t mismatches = 0;
+            for (int i = 0; i < 10000; ++i) {
+                const uint64_t high = generator();
+                const uint64_t low = generator();
+                const app::Token token{high, low};
+                const std::string hex = ReferenceHex(high, low);
+
+                std::string upper = hex;
+                for (char& c : upper) {
+                    c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+                }
+                if (token.ToHex() != hex || app::Token::FromHex(hex) != token
+                    || app::Token::FromHex(upper) != token) {
+                    ++mismatches;
+                }
+            }
+            CHECK(mismatches == 0);
+        }
+    }
+
+    GIVEN("boundary values") {
+        CHECK(app::Token{}.ToHex() == std::string(32, '0'));
+        CHECK(app::Token{~0ull, ~0ull}.ToHex() == std::string(32, 'f'));
+        CHECK(app::Token{0x0123456789abcdefull, 0xfedcba9876543210ull}.ToHex()
+              == "0123456789abcdeffedcba9876543210"s);
+    }
+
+    GIVEN("malformed input") {
+        THEN("wrong length is rejected") {
+            CHECK_FALSE(app::Token::FromHex(""sv));
+            CHECK_FALSE(app::Token::FromHex(std::string(31, 'a')));
+            CHECK_FALSE(app::Token::FromHex(std::string(33, 'a')));
+        }
+        THEN("every non-hex character is rejected at every position") {
+            size_t mismatches = 0;
+            for (int c = 0; c < 256; ++c) {
+                const bool is_hex = std::isxdigit(c) != 0;
+                for (size_t pos = 0; pos < app::Token::HEX_SIZE; ++pos) {
+                    std::string hex(app::Token::HEX_SIZE, '7');
+                    hex[pos] = static_cast<char>(c);
+                    if (app::Token::FromHex(hex).has_value() != is_hex) {
+                        ++mismatches;
+                    }
+                }
+            }
+            CHECK(mismatches == 0);
+        }
+    }
+}
+
+SCENARIO("Bearer token parsing") {
+    const std::string hex = "0123456789abcdeffedcba9876543210";
+    const auto token = app::Token::FromHex(hex);
+    REQUIRE(token);
+
+    GIVEN("well-formed headers") {
+        CHECK(app::ParseBearerToken("Bearer " + hex) == token);
+        CHECK(app::ParseBearerToken("bEARER \t " + hex) == token);
+        CHECK(app::ParseBearerToken("Bearer\n0123456789ABCDEFFEDCBA9876543210") == token);
+    }
+
+    GIVEN("malformed headers") {
+        CHECK_FALSE(app::ParseBearerToken(""));
+        CHECK_FALSE(app::ParseBearerToken("Bearer" + hex));
+        CHECK_FALSE(app::ParseBearerToken("Basic " + hex));
+        CHECK_FALSE(app::ParseBearerToken(" Bearer " + hex));
+        CHECK_FALSE(app::ParseBearerToken("Bearer " + hex + " "));
+        CHECK_FALSE(app::ParseBearerToken("Bearer " + hex + "0"));
+        CHECK_FALSE(app::ParseBearerToken("Bearer " + hex.substr(1)));
+    }
+
+    GIVEN("random headers") {
+        THEN("the parser agrees with the former regular expression") {
+            std::mt19937_64 generator{7};
+            size_t mismatches = 0;
+            size_t accepted = 0;
+            for (int i = 0; i < 100000; ++i) {
+                const std::string header = MakeFuzzHeader(generator);
+                const auto expected = ReferenceParseBearer(header);
+                if (app::ParseBearerToken(header) != expected) {
+                    ++mismatches;
+                }
+                accepted += expected.has_value();
+            }
+            CHECK(mismatches == 0);
+            // Генератор должен порождать и корректные заголовки
+            CHECK(accepted > 1000);
+        }
+    }
+}
+
+TEST_CASE("Token encoding benchmark", "[!benchmark]") {
+    std::mt19937_64 generator{42};
+    const app::Token token{generator(), generator()};
+    const std::string hex = token.ToHex();
+
+    BENCHMARK("stringstream encode") {
+        return ReferenceHex(token.GetHigh(), token.GetLow());
+    };
+    BENCHMARK("binary encode") {
+        char out[app::Token::HEX_SIZE];
+        token.ToHex(out);
+        return out[0] + out[31];
+    };
+    BENCHMARK("binary decode") {
+        return app::Token::FromHex(hex);
+    };
+
+    const std::string header = "Bearer " + hex;
+    BENCHMARK("regex bearer parse") {
+        // Так заголовок разбирался раньше: регулярное выражение строилось на каждый запрос
+        std::regex bearer_regex(R"(^Bearer\s+([0-9a-fA-F]{32})$)", std::regex::icase);
+        std::smatch match;
+        return std::regex_match(header, match, bearer_regex);
+    };
+    BENCHMARK("hand-written bearer parse") {
+        return app::ParseBearerToken(header);
+    };
+}